@@ -0,0 +1,579 @@
+/*
+ * Microbenchmarks for the data_structures library.
+ * Measures throughput and per-operation latency percentiles of insert,
+ * peek and extract on the min heap, queue, deque and linked list at sizes
+ * from 10 to 10^7, with random, sorted and reverse-sorted keys (reverse is
+ * the adversarial order for the min heap: every insert sifts up to the root)
+ * and with the heap either presized or grown through realloc from capacity 1.
+ * The inline-key d-ary heaps (4-ary and 8-ary) run the same heap scenarios.
+ *
+ * Every scenario is run twice: once timing the whole loop for throughput and
+ * once timing each operation for the latency distribution, so the timer's own
+ * cost (reported as the "timer" row) only affects the latencies.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <getopt.h>
+#include "min_heap.h"
+#include "queue.h"
+#include "deque.h"
+#include "linked_list.h"
+#include "dary_heap.h"
+#include "bucket_queue.h"
+
+#define MAX_SIZES 16
+
+// Small sizes are repeated until a scenario does at least this many operations
+#define MIN_OPS_PER_SCENARIO 1000000L
+
+// removeBack() walks the whole list, so it is only measured up to this size
+#define MAX_REMOVE_BACK_SIZE 10000L
+
+#define ORDER_RANDOM 0
+#define ORDER_SORTED 1
+#define ORDER_REVERSE 2
+#define ORDER_PRIORITY 3 // Random keys from the few priority levels of real traces
+#define ORDERS 4
+
+#define PRIORITY_LEVELS 11
+
+static const char* const order_names[ORDERS] = {"random", "sorted", "reverse", "priority"};
+
+// Same shape as the scheduler's keys: a sort key with an arrival-order tie break
+typedef struct
+{
+    int key;
+    int seq;
+} item_t;
+
+typedef struct
+{
+    const char* structure;
+    const char* operation;
+    const char* order;
+    long size;
+} scenario_t;
+
+static FILE* output;
+static const char* version = "unknown";
+static uint64_t rng_state = 1;
+
+static uint32_t* samples; // Per-operation latencies of the current scenario
+static long sample_count;
+static long sample_capacity;
+
+static uint64_t next_random()
+{
+    uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline long long now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static int compare_items(const void* a, const void* b)
+{
+    const item_t* i1 = (const item_t*)a;
+    const item_t* i2 = (const item_t*)b;
+    if (i1->key != i2->key)
+        return i1->key - i2->key;
+    return i1->seq - i2->seq;
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+    uint32_t s1 = *(const uint32_t*)a, s2 = *(const uint32_t*)b;
+    return (s1 > s2) - (s1 < s2);
+}
+
+static void fill_items(item_t* items, long n, int order)
+{
+    for (long i = 0; i < n; i++)
+    {
+        items[i].seq = (int)i;
+        if (order == ORDER_RANDOM)
+            items[i].key = (int)(next_random() % 1000000);
+        else if (order == ORDER_SORTED)
+            items[i].key = (int)i;
+        else if (order == ORDER_PRIORITY)
+            items[i].key = (int)(next_random() % PRIORITY_LEVELS);
+        else
+            items[i].key = (int)(n - i);
+    }
+}
+
+static inline void record_sample(long long elapsed_ns)
+{
+    if (sample_count < sample_capacity)
+        samples[sample_count++] = elapsed_ns > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_ns;
+}
+
+static uint32_t percentile(double p)
+{
+    long index = (long)(p * (sample_count - 1));
+    return samples[index];
+}
+
+static void report(scenario_t* scenario, long ops, long long total_ns)
+{
+    double sum = 0;
+    for (long i = 0; i < sample_count; i++)
+        sum += samples[i];
+    qsort(samples, sample_count, sizeof(uint32_t), compare_samples);
+
+    double mops = total_ns > 0 ? ops * 1000.0 / total_ns : 0;
+    fprintf(output, "%s,%s,%s,%s,%ld,%ld,%.3f,%.1f,%u,%u,%u,%u,%u\n", version, scenario->structure,
+            scenario->operation, scenario->order, scenario->size, ops, mops,
+            sample_count ? sum / sample_count : 0, percentile(0.5), percentile(0.9), percentile(0.99),
+            percentile(0.999), samples[sample_count - 1]);
+    fflush(output);
+    fprintf(stderr, "[DS_BENCH] %-13s %-12s %-7s n=%-9ld %8.3f Mops/s  p50 %u ns  p99 %u ns\n", scenario->structure,
+            scenario->operation, scenario->order, scenario->size, mops, percentile(0.5), percentile(0.99));
+}
+
+/*
+ * Each operation below runs `rounds` times over `n` elements. The `timed`
+ * pass brackets every single operation with the clock, the other one only
+ * the whole loop.
+ */
+#define TIME_OPS(timed, body)                 \
+    do                                        \
+    {                                         \
+        if (timed)                            \
+        {                                     \
+            long long op_start = now_ns();    \
+            body;                             \
+            long long op_end = now_ns();      \
+            record_sample(op_end - op_start); \
+        }                                     \
+        else                                  \
+        {                                     \
+            body;                             \
+        }                                     \
+    } while (0)
+
+// Heap operations
+#define HEAP_INSERT 0
+#define HEAP_PEEK 1
+#define HEAP_EXTRACT 2
+#define HEAP_OPS 3
+
+// Heap: insert all, peek n times, extract all
+static void bench_heap(long n, int order, int presized, long rounds)
+{
+    static const char* const names[HEAP_OPS] = {"insert", "peek", "extract"};
+    item_t* items = (item_t*)malloc(sizeof(item_t) * n);
+    scenario_t scenario = {presized ? "min_heap" : "min_heap_grow", NULL, order_names[order], n};
+
+    for (int op = 0; op < HEAP_OPS; op++)
+    {
+        long long total_ns = 0;
+        for (int timed = 0; timed < 2; timed++)
+        {
+            if (timed) sample_count = 0;
+            for (long r = 0; r < rounds; r++)
+            {
+                fill_items(items, n, order);
+                min_heap_t* heap = create_min_heap(presized ? (int)n : 1, compare_items);
+                if (op != HEAP_INSERT)
+                    for (long i = 0; i < n; i++)
+                        min_heap_insert(heap, &items[i]);
+
+                volatile void* sink = NULL;
+                long long start = now_ns();
+                for (long i = 0; i < n; i++)
+                {
+                    if (op == HEAP_INSERT)
+                        TIME_OPS(timed, min_heap_insert(heap, &items[i]));
+                    else if (op == HEAP_PEEK)
+                        TIME_OPS(timed, sink = min_heap_get_min(heap));
+                    else
+                        TIME_OPS(timed, sink = min_heap_extract_min(heap));
+                }
+                if (!timed) total_ns += now_ns() - start;
+                (void)sink;
+                destroy_min_heap(heap);
+            }
+        }
+        scenario.operation = names[op];
+        report(&scenario, n * rounds, total_ns);
+    }
+    free(items);
+}
+
+DARY_HEAP_DEFINE(heap4, int, 4)
+DARY_HEAP_DEFINE(heap8, int, 8)
+
+// Same scenarios as bench_heap() for a generated d-ary heap, keys are copied in
+#define BENCH_DARY_HEAP(name, label)                                                      \
+    static void bench_##name(long n, int order, long rounds)                              \
+    {                                                                                     \
+        static const char* const names[HEAP_OPS] = {"insert", "peek", "extract"};         \
+        item_t* items = (item_t*)malloc(sizeof(item_t) * n);                              \
+        scenario_t scenario = {label, NULL, order_names[order], n};                       \
+                                                                                          \
+        for (int op = 0; op < HEAP_OPS; op++)                                             \
+        {                                                                                 \
+            long long total_ns = 0;                                                       \
+            for (int timed = 0; timed < 2; timed++)                                       \
+            {                                                                             \
+                if (timed) sample_count = 0;                                              \
+                for (long r = 0; r < rounds; r++)                                         \
+                {                                                                         \
+                    fill_items(items, n, order);                                          \
+                    name##_t heap;                                                        \
+                    name##_init(&heap, (int)n);                                           \
+                    if (op != HEAP_INSERT)                                                \
+                        for (long i = 0; i < n; i++)                                      \
+                            name##_push(&heap, items[i].key, items[i].seq, &items[i]);    \
+                                                                                          \
+                    volatile void* sink = NULL;                                           \
+                    name##_entry_t min;                                                   \
+                    long long start = now_ns();                                           \
+                    for (long i = 0; i < n; i++)                                          \
+                    {                                                                     \
+                        if (op == HEAP_INSERT)                                            \
+                            TIME_OPS(timed, name##_push(&heap, items[i].key, items[i].seq, &items[i])); \
+                        else if (op == HEAP_PEEK)                                         \
+                            TIME_OPS(timed, sink = name##_peek(&heap)->handle);           \
+                        else                                                              \
+                            TIME_OPS(timed, name##_pop(&heap, &min); sink = min.handle);  \
+                    }                                                                     \
+                    if (!timed) total_ns += now_ns() - start;                             \
+                    (void)sink;                                                           \
+                    name##_destroy(&heap);                                                \
+                }                                                                         \
+            }                                                                             \
+            scenario.operation = names[op];                                               \
+            report(&scenario, n * rounds, total_ns);                                      \
+        }                                                                                 \
+        free(items);                                                                      \
+    }
+
+BENCH_DARY_HEAP(heap4, "dary_heap4")
+BENCH_DARY_HEAP(heap8, "dary_heap8")
+
+// Same scenarios again, keys must be bucket levels so only the priority order applies
+static void bench_bucket_queue(long n, long rounds)
+{
+    static const char* const names[HEAP_OPS] = {"insert", "peek", "extract"};
+    item_t* items = (item_t*)malloc(sizeof(item_t) * n);
+    scenario_t scenario = {"bucket_queue", NULL, order_names[ORDER_PRIORITY], n};
+
+    for (int op = 0; op < HEAP_OPS; op++)
+    {
+        long long total_ns = 0;
+        for (int timed = 0; timed < 2; timed++)
+        {
+            if (timed) sample_count = 0;
+            for (long r = 0; r < rounds; r++)
+            {
+                fill_items(items, n, ORDER_PRIORITY);
+                bucket_queue_t* queue = create_bucket_queue();
+                if (op != HEAP_INSERT)
+                    for (long i = 0; i < n; i++)
+                        bucket_queue_insert(queue, items[i].key, &items[i]);
+
+                volatile void* sink = NULL;
+                long long start = now_ns();
+                for (long i = 0; i < n; i++)
+                {
+                    if (op == HEAP_INSERT)
+                        TIME_OPS(timed, bucket_queue_insert(queue, items[i].key, &items[i]));
+                    else if (op == HEAP_PEEK)
+                        TIME_OPS(timed, sink = bucket_queue_peek(queue));
+                    else
+                        TIME_OPS(timed, sink = bucket_queue_extract_min(queue));
+                }
+                if (!timed) total_ns += now_ns() - start;
+                (void)sink;
+                destroy_bucket_queue(queue);
+            }
+        }
+        scenario.operation = names[op];
+        report(&scenario, n * rounds, total_ns);
+    }
+    free(items);
+}
+
+/*
+ * FIFO family: the structures copy every item in. The queue and linked list
+ * hand out malloc'd copies, which are freed outside the timed loops, the
+ * deque copies popped items into a caller buffer.
+ * kind 0 = queue, 1 = deque, 2 = linked_list.
+ */
+#define KIND_QUEUE 0
+#define KIND_DEQUE 1
+#define KIND_LIST 2
+
+static void fill_fifo(int kind, void* structure, item_t* items, long n, int front)
+{
+    for (long i = 0; i < n; i++)
+    {
+        if (kind == KIND_QUEUE) enqueue((Queue*)structure, &items[i]);
+        else if (kind == KIND_DEQUE)
+        {
+            if (front) pushFront((Deque*)structure, &items[i]);
+            else pushBack((Deque*)structure, &items[i]);
+        }
+        else
+        {
+            if (front) prepend((linked_list*)structure, &items[i]);
+            else append((linked_list*)structure, &items[i]);
+        }
+    }
+}
+
+static void init_fifo(int kind, void* structure)
+{
+    if (kind == KIND_QUEUE) initQueue((Queue*)structure, sizeof(item_t));
+    else if (kind == KIND_DEQUE) initDeque((Deque*)structure, sizeof(item_t));
+    else initList((linked_list*)structure, sizeof(item_t));
+}
+
+static void clear_fifo(int kind, void* structure)
+{
+    if (kind == KIND_QUEUE) clearQueue((Queue*)structure);
+    else if (kind == KIND_DEQUE) clearDeque((Deque*)structure);
+    else clearList((linked_list*)structure);
+}
+
+// Operations of the linked list family, insert ones first
+#define FIFO_PUSH_BACK 0
+#define FIFO_PUSH_FRONT 1
+#define FIFO_PEEK 2
+#define FIFO_POP_FRONT 3
+#define FIFO_POP_BACK 4
+#define FIFO_OPS 5
+
+static void* fifo_op(int kind, void* structure, int op, item_t* item)
+{
+    static item_t popped_item;
+    switch (op)
+    {
+    case FIFO_PUSH_BACK:
+        fill_fifo(kind, structure, item, 1, 0);
+        return NULL;
+    case FIFO_PUSH_FRONT:
+        fill_fifo(kind, structure, item, 1, 1);
+        return NULL;
+    case FIFO_PEEK:
+        if (kind == KIND_QUEUE) return peekQueue((Queue*)structure);
+        if (kind == KIND_DEQUE) return peekFront((Deque*)structure);
+        return getFront((linked_list*)structure);
+    case FIFO_POP_FRONT:
+        if (kind == KIND_QUEUE) return dequeue((Queue*)structure);
+        if (kind == KIND_DEQUE)
+        {
+            popFront((Deque*)structure, &popped_item);
+            return NULL;
+        }
+        return removeFront((linked_list*)structure);
+    default:
+        if (kind == KIND_DEQUE)
+        {
+            popBack((Deque*)structure, &popped_item);
+            return NULL;
+        }
+        return removeBack((linked_list*)structure);
+    }
+}
+
+static void bench_fifo(int kind, long n, long rounds)
+{
+    static const char* const structures[] = {"queue", "deque", "linked_list"};
+    static const char* const queue_ops[] = {"enqueue", NULL, "peek", "dequeue", NULL};
+    static const char* const deque_ops[] = {"push_back", "push_front", "peek_front", "pop_front", "pop_back"};
+    static const char* const list_ops[] = {"append", "prepend", "get_front", "remove_front", "remove_back"};
+    const char* const* names = kind == KIND_QUEUE ? queue_ops : (kind == KIND_DEQUE ? deque_ops : list_ops);
+
+    item_t* items = (item_t*)malloc(sizeof(item_t) * n);
+    void** popped = (void**)malloc(sizeof(void*) * n);
+    fill_items(items, n, ORDER_SORTED);
+
+    union
+    {
+        Queue queue;
+        Deque deque;
+        linked_list list;
+    } structure;
+    scenario_t scenario = {structures[kind], NULL, "fifo", n};
+
+    for (int op = 0; op < FIFO_OPS; op++)
+    {
+        if (!names[op]) continue;
+        int slow_pop_back = op == FIFO_POP_BACK && kind == KIND_LIST;
+        if (slow_pop_back && n > MAX_REMOVE_BACK_SIZE)
+        {
+            fprintf(stderr, "[DS_BENCH] %s %s skipped above %ld elements (O(n) per call)\n", structures[kind],
+                    names[op], MAX_REMOVE_BACK_SIZE);
+            continue;
+        }
+        long op_rounds = (slow_pop_back && n > 1000) ? 1 : rounds;
+
+        long long total_ns = 0;
+        for (int timed = 0; timed < 2; timed++)
+        {
+            if (timed) sample_count = 0;
+            for (long r = 0; r < op_rounds; r++)
+            {
+                init_fifo(kind, &structure);
+                if (op >= FIFO_PEEK)
+                    fill_fifo(kind, &structure, items, n, 0);
+
+                long long start = now_ns();
+                for (long i = 0; i < n; i++)
+                {
+                    void* result;
+                    TIME_OPS(timed, result = fifo_op(kind, &structure, op, &items[i]));
+                    popped[i] = result;
+                }
+                if (!timed) total_ns += now_ns() - start;
+
+                if (op >= FIFO_POP_FRONT)
+                    for (long i = 0; i < n; i++)
+                        free(popped[i]);
+                clear_fifo(kind, &structure);
+            }
+        }
+        scenario.operation = names[op];
+        report(&scenario, n * op_rounds, total_ns);
+    }
+    free(popped);
+    free(items);
+}
+
+// Cost of one clock read, the floor under every latency
+static void bench_timer()
+{
+    scenario_t scenario = {"timer", "clock_gettime", "-", 1};
+    sample_count = 0;
+    long long start = now_ns();
+    for (long i = 0; i < MIN_OPS_PER_SCENARIO; i++)
+    {
+        long long op_start = now_ns();
+        record_sample(now_ns() - op_start);
+    }
+    report(&scenario, MIN_OPS_PER_SCENARIO, now_ns() - start);
+}
+
+static int selected(const char* list, const char* name)
+{
+    if (!list) return 1;
+    size_t length = strlen(name);
+    for (const char* p = strstr(list, name); p; p = strstr(p + 1, name))
+        if ((p == list || p[-1] == ',') && (p[length] == ',' || p[length] == '\0'))
+            return 1;
+    return 0;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n <sizes>        comma-separated sizes (default 10,100,1000,10000,100000,1000000,10000000)\n"
+            "  -s <structures>   any of min_heap,min_heap_grow,dary_heap4,dary_heap8,bucket_queue,queue,deque,\n"
+            "                    linked_list (default all)\n"
+            "  -r <seed>         seed of the random key order (default 1)\n"
+            "  -o <file>         append CSV rows to this file instead of stdout\n"
+            "  -v <version>      version label of the rows (default unknown)\n",
+            name);
+}
+
+int main(int argc, char* argv[])
+{
+    char default_sizes[] = "10,100,1000,10000,100000,1000000,10000000";
+    char* size_list = default_sizes;
+    const char* structures = NULL;
+    const char* output_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:r:o:v:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': size_list = optarg;
+            break;
+        case 's': structures = optarg;
+            break;
+        case 'r': rng_state = strtoull(optarg, NULL, 10);
+            break;
+        case 'o': output_path = optarg;
+            break;
+        case 'v': version = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    long sizes[MAX_SIZES];
+    int size_count = 0;
+    for (char* s = strtok(size_list, ","); s && size_count < MAX_SIZES; s = strtok(NULL, ","))
+        if ((sizes[size_count] = atol(s)) > 0)
+            size_count++;
+
+    output = output_path ? fopen(output_path, "a") : stdout;
+    if (!output)
+    {
+        perror("[DS_BENCH] Failed to open output");
+        return EXIT_FAILURE;
+    }
+    if (ftell(output) <= 0)
+        fprintf(output, "version,structure,operation,order,size,ops,mops_per_s,mean_ns,p50_ns,p90_ns,p99_ns,"
+                "p999_ns,max_ns\n");
+
+    long max_size = 0;
+    for (int i = 0; i < size_count; i++)
+        if (sizes[i] > max_size) max_size = sizes[i];
+    sample_capacity = max_size > MIN_OPS_PER_SCENARIO ? max_size : MIN_OPS_PER_SCENARIO;
+    samples = (uint32_t*)malloc(sizeof(uint32_t) * sample_capacity);
+    if (!samples)
+    {
+        perror("[DS_BENCH] Failed to allocate latency samples");
+        return EXIT_FAILURE;
+    }
+
+    bench_timer();
+    for (int s = 0; s < size_count; s++)
+    {
+        long n = sizes[s];
+        long rounds = n < MIN_OPS_PER_SCENARIO ? MIN_OPS_PER_SCENARIO / n : 1;
+
+        for (int order = 0; order < ORDERS; order++)
+        {
+            if (selected(structures, "min_heap"))
+                bench_heap(n, order, 1, rounds);
+            // Growth path from capacity 1, key order does not change the reallocs
+            if (order == ORDER_RANDOM && selected(structures, "min_heap_grow"))
+                bench_heap(n, order, 0, rounds);
+            if (selected(structures, "dary_heap4"))
+                bench_heap4(n, order, rounds);
+            if (selected(structures, "dary_heap8"))
+                bench_heap8(n, order, rounds);
+        }
+        if (selected(structures, "bucket_queue"))
+            bench_bucket_queue(n, rounds);
+        if (selected(structures, "queue"))
+            bench_fifo(KIND_QUEUE, n, rounds);
+        if (selected(structures, "deque"))
+            bench_fifo(KIND_DEQUE, n, rounds);
+        if (selected(structures, "linked_list"))
+            bench_fifo(KIND_LIST, n, rounds);
+    }
+
+    free(samples);
+    if (output != stdout)
+        fclose(output);
+    return EXIT_SUCCESS;
+}
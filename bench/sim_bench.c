@@ -0,0 +1,387 @@
+/*
+ * Simulator overhead benchmark.
+ * Runs the benchmark build of os-sim (-DOS_SIM_BENCH) for every engine,
+ * algorithm and workload size and appends one CSV row per run with the host
+ * CPU time per simulated tick, syscalls per tick (when strace is installed),
+ * scheduling-decision and arrival-to-enqueue latency from scheduler.bench,
+ * and the peak RSS of any simulator process.
+ *
+ * The runner is a child subreaper, so every process of a run, orphaned or
+ * not, is reaped here and its resource usage is counted.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_VALUES 32
+
+// Runs get their own IPC namespace, away from simulations started by hand
+#define BENCH_IPC_NAMESPACE 900
+
+typedef struct
+{
+    long long count;
+    long long mean_ns;
+    long long max_ns;
+} probe_result_t;
+
+typedef struct
+{
+    int status;
+    int ticks;
+    double wall_ms;
+    double cpu_ms;
+    long peak_rss_kb;
+    long syscalls; // -1 when not measured
+    probe_result_t decision;
+    probe_result_t enqueue;
+} bench_result_t;
+
+static char os_sim_path[PATH_MAX];
+static char process_path[PATH_MAX];
+static char gen_path[PATH_MAX];
+static const char* work_dir = "build/bench/runs";
+static long tick_us = 20000;
+static int timeout_s = 600;
+static volatile pid_t run_group = 0;
+
+static int split_list(char* list, char** out)
+{
+    int count = 0;
+    for (char* item = strtok(list, ","); item && count < MAX_VALUES; item = strtok(NULL, ","))
+        out[count++] = item;
+    return count;
+}
+
+static double now_ms()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+static void sibling_path(const char* self, const char* name, char* out)
+{
+    char dir[PATH_MAX];
+    if (!realpath(self, dir))
+        strcpy(dir, ".");
+    char* slash = strrchr(dir, '/');
+    if (slash) *slash = '\0';
+    snprintf(out, PATH_MAX, "%s/%s", dir, name);
+}
+
+static void on_timeout(__attribute__((unused)) int signum)
+{
+    if (run_group > 0)
+        killpg(run_group, SIGKILL);
+}
+
+// Runs `argv` to completion, returns its exit status
+static int run_command(char* const argv[])
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd != -1)
+            dup2(null_fd, STDOUT_FILENO);
+        execv(argv[0], argv);
+        perror("[BENCH] execv failed");
+        _exit(1);
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) == -1)
+        return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/*
+ * Starts os-sim in `dir` in a process group of its own (optionally under
+ * strace), then reaps every process of the run, summing their CPU time and
+ * keeping the largest RSS.
+ */
+static int run_simulation(const char* dir, const char* algorithm, const char* workload, const char* engine,
+                          int use_strace, bench_result_t* result)
+{
+    double start = now_ms();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        setpgid(0, 0);
+        if (chdir(dir) == -1)
+            _exit(1);
+
+        char tick[32], ns[16];
+        snprintf(tick, sizeof(tick), "%ld", tick_us);
+        snprintf(ns, sizeof(ns), "%d", BENCH_IPC_NAMESPACE);
+        setenv("OS_SIM_TICK_US", tick, 1);
+        setenv("OS_SIM_IPC_NS", ns, 1);
+
+        int out = open("os-sim.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out != -1)
+        {
+            dup2(out, STDOUT_FILENO);
+            dup2(out, STDERR_FILENO);
+            close(out);
+        }
+
+        char engine_arg[32];
+        snprintf(engine_arg, sizeof(engine_arg), "--engine=%s", engine);
+        if (use_strace)
+            execlp("strace", "strace", "-f", "-c", "-o", "strace.txt", os_sim_path, "-s", algorithm, "-q", "2",
+                   "-f", workload, engine_arg, (char*)NULL);
+        else
+            execl(os_sim_path, "os-sim", "-s", algorithm, "-q", "2", "-f", workload, engine_arg, (char*)NULL);
+        perror("[BENCH] exec failed");
+        _exit(1);
+    }
+    if (pid < 0)
+    {
+        perror("[BENCH] fork failed");
+        return -1;
+    }
+
+    setpgid(pid, pid);
+    run_group = pid;
+    alarm(timeout_s);
+
+    result->status = -1;
+    result->cpu_ms = 0;
+    result->peak_rss_kb = 0;
+
+    int status;
+    struct rusage usage;
+    pid_t reaped;
+    while ((reaped = wait4(-1, &status, 0, &usage)) != -1 || errno == EINTR)
+    {
+        if (reaped == -1) continue;
+        result->cpu_ms += usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0;
+        result->cpu_ms += usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+        if (usage.ru_maxrss > result->peak_rss_kb)
+            result->peak_rss_kb = usage.ru_maxrss;
+        if (reaped == pid)
+            result->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    }
+
+    alarm(0);
+    run_group = 0;
+    result->wall_ms = now_ms() - start;
+    return result->status;
+}
+
+static void read_bench_report(const char* dir, bench_result_t* result)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/scheduler.bench", dir);
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return;
+
+    char name[32];
+    long long count, mean_ns, max_ns;
+    if (fscanf(file, "ticks %d\n", &result->ticks) != 1)
+        result->ticks = 0;
+    while (fscanf(file, "%31s %lld %lld %lld\n", name, &count, &mean_ns, &max_ns) == 4)
+    {
+        probe_result_t probe = {count, mean_ns, max_ns};
+        if (strcmp(name, "decision") == 0)
+            result->decision = probe;
+        else if (strcmp(name, "enqueue") == 0)
+            result->enqueue = probe;
+    }
+    fclose(file);
+}
+
+// Total call count from the summary line of `strace -c`
+static long read_strace_calls(const char* dir)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/strace.txt", dir);
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    long calls = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        double percent, seconds;
+        long usecs_per_call, total;
+        if (strstr(line, "total") &&
+            sscanf(line, "%lf %lf %ld %ld", &percent, &seconds, &usecs_per_call, &total) == 4)
+            calls = total;
+    }
+    fclose(file);
+    return calls;
+}
+
+static int strace_available()
+{
+    char* argv[] = {"/bin/sh", "-c", "command -v strace", NULL};
+    return run_command(argv) == 0;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -a <algorithms>   comma-separated rr,hpf,srtn (default rr,hpf,srtn)\n"
+            "  -n <sizes>        workload sizes for the des engine (default 1000,10000,100000)\n"
+            "  -p <sizes>        workload sizes for the proc engine, empty to skip it (default 20,50)\n"
+            "  -t <us>           tick length of proc engine runs in microseconds (default 20000)\n"
+            "  -T <seconds>      timeout of a single run (default 600)\n"
+            "  -d <dir>          working directory (default build/bench/runs)\n"
+            "  -o <file>         CSV file the results are appended to (default bench/results.csv)\n"
+            "  -v <version>      version label of the rows (default unknown)\n"
+            "  -S                skip the strace pass that counts syscalls\n",
+            name);
+}
+
+int main(int argc, char* argv[])
+{
+    char default_algorithms[] = "rr,hpf,srtn";
+    char default_des_sizes[] = "1000,10000,100000";
+    char default_proc_sizes[] = "20,50";
+    char* algorithm_list = default_algorithms;
+    char* des_size_list = default_des_sizes;
+    char* proc_size_list = default_proc_sizes;
+    const char* output = "bench/results.csv";
+    const char* version = "unknown";
+    int count_syscalls = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "a:n:p:t:T:d:o:v:S")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a': algorithm_list = optarg;
+            break;
+        case 'n': des_size_list = optarg;
+            break;
+        case 'p': proc_size_list = optarg;
+            break;
+        case 't': tick_us = atol(optarg);
+            break;
+        case 'T': timeout_s = atoi(optarg);
+            break;
+        case 'd': work_dir = optarg;
+            break;
+        case 'o': output = optarg;
+            break;
+        case 'v': version = optarg;
+            break;
+        case 'S': count_syscalls = 0;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    char* algorithms[MAX_VALUES];
+    char* engine_sizes[2][MAX_VALUES];
+    const char* engines[2] = {"des", "proc"};
+    int algorithm_count = split_list(algorithm_list, algorithms);
+    int size_counts[2] = {split_list(des_size_list, engine_sizes[0]), split_list(proc_size_list, engine_sizes[1])};
+
+    sibling_path(argv[0], "os-sim", os_sim_path);
+    sibling_path(argv[0], "process", process_path);
+    sibling_path(argv[0], "os-sim-gen", gen_path);
+
+    if (prctl(PR_SET_CHILD_SUBREAPER, 1) == -1)
+        perror("[BENCH] Cannot become a subreaper, CPU time of orphaned processes is lost");
+    signal(SIGALRM, on_timeout);
+
+    if (count_syscalls && !strace_available())
+    {
+        fprintf(stderr, "[BENCH] strace not found, syscall counts are skipped\n");
+        count_syscalls = 0;
+    }
+
+    char command[PATH_MAX + 16];
+    snprintf(command, sizeof(command), "mkdir -p %s", work_dir);
+    char* mkdir_argv[] = {"/bin/sh", "-c", command, NULL};
+    run_command(mkdir_argv);
+
+    FILE* csv = fopen(output, "a");
+    if (!csv)
+    {
+        perror("[BENCH] Failed to open results");
+        return EXIT_FAILURE;
+    }
+    if (ftell(csv) == 0)
+        fprintf(csv, "version,timestamp,engine,algorithm,processes,status,ticks,wall_ms,cpu_ms,cpu_us_per_tick,"
+                "syscalls,syscalls_per_tick,decisions,decision_mean_ns,decision_max_ns,arrivals,enqueue_mean_ns,"
+                "enqueue_max_ns,peak_rss_kb\n");
+    long timestamp = (long)time(NULL);
+
+    for (int e = 0; e < 2; e++)
+        for (int s = 0; s < size_counts[e]; s++)
+        {
+            // One workload per size, shared by every algorithm
+            char workload[PATH_MAX];
+            snprintf(workload, sizeof(workload), "%s/workload-%s.txt", work_dir, engine_sizes[e][s]);
+            char* gen_argv[] = {gen_path, "-n", engine_sizes[e][s], "-s", "1", "-o", workload, NULL};
+            char absolute[PATH_MAX];
+            if (run_command(gen_argv) != 0 || !realpath(workload, absolute))
+            {
+                fprintf(stderr, "[BENCH] Failed to generate workload of %s processes\n", engine_sizes[e][s]);
+                continue;
+            }
+
+            for (int a = 0; a < algorithm_count; a++)
+            {
+                char dir[PATH_MAX];
+                snprintf(dir, sizeof(dir), "%s/%s-%s-%s", work_dir, engines[e], algorithms[a], engine_sizes[e][s]);
+                mkdir(dir, 0755);
+                char link[PATH_MAX + 16];
+                snprintf(link, sizeof(link), "%s/process", dir);
+                unlink(link);
+                if (symlink(process_path, link) == -1)
+                    perror("[BENCH] symlink process failed");
+
+                bench_result_t result = {0};
+                result.syscalls = -1;
+                if (count_syscalls)
+                {
+                    bench_result_t traced = {0};
+                    run_simulation(dir, algorithms[a], absolute, engines[e], 1, &traced);
+                    result.syscalls = read_strace_calls(dir);
+                }
+                run_simulation(dir, algorithms[a], absolute, engines[e], 0, &result);
+                read_bench_report(dir, &result);
+
+                int ticks = result.ticks > 0 ? result.ticks : 1;
+                fprintf(csv, "%s,%ld,%s,%s,%s,%d,%d,%.1f,%.1f,%.3f,", version, timestamp, engines[e],
+                        algorithms[a], engine_sizes[e][s], result.status, result.ticks, result.wall_ms, result.cpu_ms,
+                        result.cpu_ms * 1000.0 / ticks);
+                if (result.syscalls >= 0)
+                    fprintf(csv, "%ld,%.2f,", result.syscalls, (double)result.syscalls / ticks);
+                else
+                    fprintf(csv, ",,");
+                fprintf(csv, "%lld,%lld,%lld,%lld,%lld,%lld,%ld\n", result.decision.count, result.decision.mean_ns,
+                        result.decision.max_ns, result.enqueue.count, result.enqueue.mean_ns, result.enqueue.max_ns,
+                        result.peak_rss_kb);
+                fflush(csv);
+
+                printf("[BENCH] %s %s n=%s: status %d, %d ticks, %.1f ms CPU (%.3f us/tick), peak RSS %ld KB\n",
+                       engines[e], algorithms[a], engine_sizes[e][s], result.status, result.ticks, result.cpu_ms,
+                       result.cpu_ms * 1000.0 / ticks, result.peak_rss_kb);
+            }
+        }
+
+    fclose(csv);
+    printf("[BENCH] Results appended to %s\n", output);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bucket_queue.h"
+
+#define BUCKET_QUEUE_SLAB_NODES 256
+
+// Carves a new slab of nodes into the free list
+static void grow(bucket_queue_t* queue) {
+    bucket_queue_node_t* slab = malloc(sizeof(bucket_queue_node_t) * BUCKET_QUEUE_SLAB_NODES);
+    void** slabs = realloc(queue->slabs, sizeof(void*) * (queue->slab_count + 1));
+    if (!slab || !slabs) {
+        perror("Failed to grow bucket queue");
+        exit(EXIT_FAILURE);
+    }
+    queue->slabs = slabs;
+    queue->slabs[queue->slab_count++] = slab;
+
+    for (int i = 0; i < BUCKET_QUEUE_SLAB_NODES; i++) {
+        slab[i].next = queue->free_nodes;
+        queue->free_nodes = &slab[i];
+    }
+}
+
+bucket_queue_t* create_bucket_queue(void) {
+    bucket_queue_t* queue = malloc(sizeof(bucket_queue_t));
+    if (!queue) {
+        perror("Failed to allocate bucket queue");
+        return NULL;
+    }
+    memset(queue, 0, sizeof(bucket_queue_t));
+    return queue;
+}
+
+bucket_queue_node_t* bucket_queue_insert_ordered(bucket_queue_t* queue, int level, int order, void* item) {
+    if (!bucket_queue_fits(level)) return NULL;
+    if (!queue->free_nodes) grow(queue);
+
+    bucket_queue_node_t* node = queue->free_nodes;
+    queue->free_nodes = node->next;
+    node->item = item;
+    node->level = level;
+    node->order = order;
+
+    // Walk back from the tail past the items that order after this one
+    bucket_t* bucket = &queue->buckets[level];
+    bucket_queue_node_t* prev = bucket->tail;
+    while (prev && prev->order > order)
+        prev = prev->prev;
+
+    node->prev = prev;
+    node->next = prev ? prev->next : bucket->head;
+    if (node->next) node->next->prev = node;
+    else bucket->tail = node;
+    if (prev) prev->next = node;
+    else bucket->head = node;
+
+    queue->bitmap |= 1ULL << level;
+    queue->size++;
+    return node;
+}
+
+bucket_queue_node_t* bucket_queue_insert(bucket_queue_t* queue, int level, void* item) {
+    if (!bucket_queue_fits(level)) return NULL;
+    // Appends, taking the tail's order keeps the level sorted for ordered inserts
+    bucket_queue_node_t* tail = queue->buckets[level].tail;
+    return bucket_queue_insert_ordered(queue, level, tail ? tail->order : INT_MIN, item);
+}
+
+int bucket_queue_min_level(bucket_queue_t* queue) {
+    return queue->bitmap ? __builtin_ctzll(queue->bitmap) : -1;
+}
+
+void* bucket_queue_peek(bucket_queue_t* queue) {
+    if (!queue->bitmap) return NULL;
+    return queue->buckets[__builtin_ctzll(queue->bitmap)].head->item;
+}
+
+void bucket_queue_remove(bucket_queue_t* queue, bucket_queue_node_t* node) {
+    bucket_t* bucket = &queue->buckets[node->level];
+    if (node->prev) node->prev->next = node->next;
+    else bucket->head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else bucket->tail = node->prev;
+
+    if (!bucket->head)
+        queue->bitmap &= ~(1ULL << node->level);
+    queue->size--;
+
+    node->next = queue->free_nodes;
+    queue->free_nodes = node;
+}
+
+void* bucket_queue_extract_min(bucket_queue_t* queue) {
+    if (!queue->bitmap) return NULL;
+    bucket_queue_node_t* node = queue->buckets[__builtin_ctzll(queue->bitmap)].head;
+    void* item = node->item;
+    bucket_queue_remove(queue, node);
+    return item;
+}
+
+int bucket_queue_is_empty(bucket_queue_t* queue) {
+    return queue->size == 0;
+}
+
+int bucket_queue_size(bucket_queue_t* queue) {
+    return queue->size;
+}
+
+void destroy_bucket_queue(bucket_queue_t* queue) {
+    for (int i = 0; i < queue->slab_count; i++)
+        free(queue->slabs[i]);
+    free(queue->slabs);
+    free(queue);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Bucket priority queue for small integer keys in [0, BUCKET_QUEUE_LEVELS).
+ * Every level is a FIFO list and a bit per level marks the non-empty ones,
+ * so the minimum is found with a single find-first-set. Insert, extract and
+ * remove are O(1) whatever the number of items; items of equal key come out
+ * in insertion order, or ordered by a secondary key when inserted with
+ * bucket_queue_insert_ordered().
+ */
+#define BUCKET_QUEUE_LEVELS 64
+
+typedef struct bucket_queue_node {
+    void* item;
+    int level;
+    int order; // Secondary key, non-decreasing from head to tail
+    struct bucket_queue_node* prev;
+    struct bucket_queue_node* next;
+} bucket_queue_node_t;
+
+typedef struct {
+    bucket_queue_node_t* head;
+    bucket_queue_node_t* tail;
+} bucket_t;
+
+typedef struct bucket_queue {
+    bucket_t buckets[BUCKET_QUEUE_LEVELS];
+    uint64_t bitmap; // Bit i is set when buckets[i] is not empty
+    int size;
+    bucket_queue_node_t* free_nodes; // Recycled nodes, linked through next
+    void** slabs; // Node allocations, released by destroy_bucket_queue()
+    int slab_count;
+} bucket_queue_t;
+
+static inline int bucket_queue_fits(int level) {
+    return level >= 0 && level < BUCKET_QUEUE_LEVELS;
+}
+
+bucket_queue_t* create_bucket_queue(void);
+// Returns the item's node (to pass to bucket_queue_remove), NULL if the level does not fit
+bucket_queue_node_t* bucket_queue_insert(bucket_queue_t* queue, int level, void* item);
+// Inserts after every item of the level whose order is not greater, O(1) when orders arrive non-decreasing
+bucket_queue_node_t* bucket_queue_insert_ordered(bucket_queue_t* queue, int level, int order, void* item);
+void* bucket_queue_peek(bucket_queue_t* queue);
+// Level of the minimum, -1 when empty
+int bucket_queue_min_level(bucket_queue_t* queue);
+void* bucket_queue_extract_min(bucket_queue_t* queue);
+void bucket_queue_remove(bucket_queue_t* queue, bucket_queue_node_t* node);
+int bucket_queue_is_empty(bucket_queue_t* queue);
+int bucket_queue_size(bucket_queue_t* queue);
+void destroy_bucket_queue(bucket_queue_t* queue);
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "buddy_allocator.h"
+
+static int is_power_of_two(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+static void push_free(buddy_allocator_t* buddy, int unit, int order) {
+    buddy->order[unit] = (signed char)order;
+    buddy->is_free[unit] = 1;
+    buddy->prev[unit] = -1;
+    buddy->next[unit] = buddy->free_heads[order];
+    if (buddy->free_heads[order] != -1)
+        buddy->prev[buddy->free_heads[order]] = unit;
+    buddy->free_heads[order] = unit;
+    buddy->free_orders |= 1u << order;
+}
+
+static void remove_free(buddy_allocator_t* buddy, int unit) {
+    int order = buddy->order[unit];
+    if (buddy->prev[unit] != -1) buddy->next[buddy->prev[unit]] = buddy->next[unit];
+    else buddy->free_heads[order] = buddy->next[unit];
+    if (buddy->next[unit] != -1) buddy->prev[buddy->next[unit]] = buddy->prev[unit];
+    if (buddy->free_heads[order] == -1)
+        buddy->free_orders &= ~(1u << order);
+    buddy->is_free[unit] = 0;
+}
+
+// Smallest order whose block holds `bytes`, -1 if even the whole space is too small
+static int order_for(buddy_allocator_t* buddy, int bytes) {
+    if (bytes > buddy->size) return -1;
+    int order = 0;
+    while (((long long)buddy->min_block << order) < bytes)
+        order++;
+    return order;
+}
+
+buddy_allocator_t* create_buddy_allocator(int size, int min_block) {
+    if (!is_power_of_two(size) || !is_power_of_two(min_block) || min_block > size)
+        return NULL;
+
+    buddy_allocator_t* buddy = malloc(sizeof(buddy_allocator_t));
+    if (!buddy) {
+        perror("Failed to allocate buddy allocator");
+        return NULL;
+    }
+    int units = size / min_block;
+    buddy->size = size;
+    buddy->min_block = min_block;
+    buddy->max_order = __builtin_ctz(units);
+    buddy->next = malloc(sizeof(int) * units);
+    buddy->prev = malloc(sizeof(int) * units);
+    buddy->order = malloc(units);
+    buddy->is_free = calloc(units, 1);
+    if (!buddy->next || !buddy->prev || !buddy->order || !buddy->is_free) {
+        perror("Failed to allocate buddy allocator");
+        destroy_buddy_allocator(buddy);
+        return NULL;
+    }
+    memset(buddy->order, -1, units);
+    for (int i = 0; i < BUDDY_MAX_ORDERS; i++)
+        buddy->free_heads[i] = -1;
+    buddy->free_orders = 0;
+    buddy->free_bytes = size;
+    push_free(buddy, 0, buddy->max_order);
+    return buddy;
+}
+
+int buddy_block_size(buddy_allocator_t* buddy, int bytes) {
+    int order = order_for(buddy, bytes);
+    return order < 0 ? -1 : buddy->min_block << order;
+}
+
+int buddy_alloc(buddy_allocator_t* buddy, int bytes) {
+    int order = order_for(buddy, bytes);
+    if (order < 0) return -1;
+    uint32_t candidates = buddy->free_orders >> order;
+    if (!candidates) return -1;
+
+    int found = order + __builtin_ctz(candidates);
+    int unit = buddy->free_heads[found];
+    remove_free(buddy, unit);
+    // Split down, the upper halves go back to the free lists
+    while (found > order) {
+        found--;
+        push_free(buddy, unit + (1 << found), found);
+    }
+    buddy->order[unit] = (signed char)order;
+    buddy->free_bytes -= buddy->min_block << order;
+    return unit * buddy->min_block;
+}
+
+int buddy_free(buddy_allocator_t* buddy, int address) {
+    if (address < 0 || address >= buddy->size || address % buddy->min_block) return -1;
+    int unit = address / buddy->min_block;
+    if (buddy->order[unit] < 0 || buddy->is_free[unit]) return -1;
+
+    int order = buddy->order[unit];
+    int freed = buddy->min_block << order;
+    buddy->free_bytes += freed;
+    // Merge while the buddy is a free block of the same order
+    while (order < buddy->max_order) {
+        int other = unit ^ (1 << order);
+        if (!buddy->is_free[other] || buddy->order[other] != order) break;
+        remove_free(buddy, other);
+        buddy->order[unit > other ? unit : other] = -1;
+        unit = unit < other ? unit : other;
+        order++;
+    }
+    push_free(buddy, unit, order);
+    return freed;
+}
+
+int buddy_free_bytes(buddy_allocator_t* buddy) {
+    return buddy->free_bytes;
+}
+
+int buddy_largest_free(buddy_allocator_t* buddy) {
+    if (!buddy->free_orders) return 0;
+    return buddy->min_block << (31 - __builtin_clz(buddy->free_orders));
+}
+
+void destroy_buddy_allocator(buddy_allocator_t* buddy) {
+    free(buddy->next);
+    free(buddy->prev);
+    free(buddy->order);
+    free(buddy->is_free);
+    free(buddy);
+}
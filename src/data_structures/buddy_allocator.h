@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Binary buddy allocator over a simulated address space [0, size).
+ * Blocks are powers of two from min_block to size bytes. Free blocks of each
+ * order are kept in intrusive lists indexed by address and a bitmap marks the
+ * orders that have one, so allocation splits from the smallest free order
+ * that fits and freeing merges with the buddy while it is free too.
+ * Addresses are offsets, no real memory is handed out.
+ */
+#define BUDDY_MAX_ORDERS 31
+
+typedef struct buddy_allocator {
+    int size; // Bytes, a power of two
+    int min_block; // Bytes, a power of two
+    int max_order; // Order of the whole space, size == min_block << max_order
+    int* next; // Free list links per min_block unit, -1 ends a list
+    int* prev;
+    signed char* order; // Order of the block starting at each unit, -1 elsewhere
+    unsigned char* is_free; // Per unit, set on the first unit of a free block
+    int free_heads[BUDDY_MAX_ORDERS];
+    uint32_t free_orders; // Bit k is set when free_heads[k] is not empty
+    int free_bytes;
+} buddy_allocator_t;
+
+// Returns NULL when size or min_block is not a power of two or min_block > size
+buddy_allocator_t* create_buddy_allocator(int size, int min_block);
+// Size of the block a request of `bytes` gets, -1 if it can never fit
+int buddy_block_size(buddy_allocator_t* buddy, int bytes);
+// Address of a block of at least `bytes`, -1 when no free block is large enough
+int buddy_alloc(buddy_allocator_t* buddy, int bytes);
+// Frees the block at `address`, returns its size or -1 if no block was allocated there
+int buddy_free(buddy_allocator_t* buddy, int address);
+int buddy_free_bytes(buddy_allocator_t* buddy);
+int buddy_largest_free(buddy_allocator_t* buddy);
+void destroy_buddy_allocator(buddy_allocator_t* buddy);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * d-ary min heap with inline keys, generated per key type.
+ *
+ * DARY_HEAP_DEFINE(name, key_type, arity) defines name##_t and its functions.
+ * Every entry holds (key, tiebreak, handle) by value and entries are ordered by
+ * key then tiebreak with the built-in < of key_type, so sifting never follows a
+ * pointer or calls a comparator. With int keys an entry is 16 bytes: the array
+ * is cache-line aligned and shifted so the children of every node start on a
+ * line, a 4-ary sibling group fills exactly one line (8-ary: two).
+ */
+
+#define DARY_HEAP_CACHE_LINE 64
+
+#define DARY_HEAP_DEFINE(name, key_type, arity)                                                            \
+    typedef struct {                                                                                       \
+        key_type key;                                                                                      \
+        int tiebreak;                                                                                      \
+        void* handle;                                                                                      \
+    } name##_entry_t;                                                                                      \
+                                                                                                           \
+    typedef struct {                                                                                       \
+        name##_entry_t* data; /* data[0] is the root */                                                    \
+        void* block; /* Aligned allocation holding data */                                                 \
+        int size;                                                                                          \
+        int capacity;                                                                                      \
+    } name##_t;                                                                                            \
+                                                                                                           \
+    /* Entries in front of the root so that data[1] starts a cache line */                                 \
+    enum { name##_pad = sizeof(name##_entry_t) < DARY_HEAP_CACHE_LINE                                      \
+        ? DARY_HEAP_CACHE_LINE / sizeof(name##_entry_t) - 1 : 0 };                                         \
+                                                                                                           \
+    static inline int name##_less(const name##_entry_t* a, const name##_entry_t* b) {                      \
+        return a->key < b->key || (a->key == b->key && a->tiebreak < b->tiebreak);                         \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_reserve(name##_t* heap, int capacity) {                                      \
+        void* block;                                                                                       \
+        if (posix_memalign(&block, DARY_HEAP_CACHE_LINE, sizeof(name##_entry_t) * (capacity + name##_pad))) { \
+            perror("Failed to allocate heap");                                                             \
+            exit(EXIT_FAILURE);                                                                            \
+        }                                                                                                  \
+        name##_entry_t* data = (name##_entry_t*)block + name##_pad;                                        \
+        if (heap->size)                                                                                    \
+            memcpy(data, heap->data, sizeof(name##_entry_t) * heap->size);                                 \
+        free(heap->block);                                                                                 \
+        heap->block = block;                                                                               \
+        heap->data = data;                                                                                 \
+        heap->capacity = capacity;                                                                         \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_init(name##_t* heap, int capacity) {                                         \
+        heap->data = NULL;                                                                                 \
+        heap->block = NULL;                                                                                \
+        heap->size = 0;                                                                                    \
+        heap->capacity = 0;                                                                                \
+        name##_reserve(heap, capacity > 0 ? capacity : 1);                                                 \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_destroy(name##_t* heap) {                                                    \
+        free(heap->block);                                                                                 \
+        heap->block = NULL;                                                                                \
+        heap->data = NULL;                                                                                 \
+        heap->size = heap->capacity = 0;                                                                   \
+    }                                                                                                      \
+                                                                                                           \
+    static inline int name##_is_empty(name##_t* heap) {                                                    \
+        return heap->size == 0;                                                                            \
+    }                                                                                                      \
+                                                                                                           \
+    static inline void name##_push(name##_t* heap, key_type key, int tiebreak, void* handle) {             \
+        if (heap->size == heap->capacity)                                                                  \
+            name##_reserve(heap, heap->capacity * 2);                                                      \
+        name##_entry_t entry = {key, tiebreak, handle};                                                    \
+        int index = heap->size++;                                                                          \
+        /* Move parents down into the hole instead of swapping */                                          \
+        while (index > 0) {                                                                                \
+            int parent = (index - 1) / (arity);                                                            \
+            if (!name##_less(&entry, &heap->data[parent])) break;                                          \
+            heap->data[index] = heap->data[parent];                                                        \
+            index = parent;                                                                                \
+        }                                                                                                  \
+        heap->data[index] = entry;                                                                         \
+    }                                                                                                      \
+                                                                                                           \
+    static inline name##_entry_t* name##_peek(name##_t* heap) {                                            \
+        return heap->size > 0 ? &heap->data[0] : NULL;                                                     \
+    }                                                                                                      \
+                                                                                                           \
+    /* Copies the minimum into `out` (if not NULL), returns 0 when empty */                                \
+    static inline int name##_pop(name##_t* heap, name##_entry_t* out) {                                    \
+        if (heap->size == 0) return 0;                                                                     \
+        if (out) *out = heap->data[0];                                                                     \
+        name##_entry_t last = heap->data[--heap->size];                                                    \
+        int size = heap->size;                                                                             \
+        int index = 0;                                                                                     \
+        while (1) {                                                                                        \
+            int first = index * (arity) + 1;                                                               \
+            if (first >= size) break;                                                                      \
+            int last_child = first + (arity) < size ? first + (arity) : size;                              \
+            int smallest = first;                                                                          \
+            for (int child = first + 1; child < last_child; child++)                                       \
+                if (name##_less(&heap->data[child], &heap->data[smallest]))                                \
+                    smallest = child;                                                                      \
+            if (!name##_less(&heap->data[smallest], &last)) break;                                         \
+            heap->data[index] = heap->data[smallest];                                                      \
+            index = smallest;                                                                              \
+        }                                                                                                  \
+        if (size) heap->data[index] = last;                                                                \
+        return 1;                                                                                          \
+    }
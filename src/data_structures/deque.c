@@ -1,38 +1,89 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "deque.h"
 
+#define DEQUE_INITIAL_CAPACITY 16
+
+static void* slot(Deque* dq, size_t index) {
+    return dq->buffer + ((dq->head + index) & (dq->capacity - 1)) * dq->dataSize;
+}
+
+// Doubles the buffer, unwrapping the items so the front is at index 0
+static void grow(Deque* dq) {
+    size_t capacity = dq->capacity ? dq->capacity * 2 : DEQUE_INITIAL_CAPACITY;
+    char* buffer = malloc(capacity * dq->dataSize);
+    if (!buffer) {
+        perror("Failed to grow deque");
+        exit(EXIT_FAILURE);
+    }
+
+    if (dq->size) {
+        size_t first = dq->capacity - dq->head; // Items from head to the end of the old buffer
+        if (first > dq->size) first = dq->size;
+        memcpy(buffer, dq->buffer + dq->head * dq->dataSize, first * dq->dataSize);
+        memcpy(buffer + first * dq->dataSize, dq->buffer, (dq->size - first) * dq->dataSize);
+    }
+
+    free(dq->buffer);
+    dq->buffer = buffer;
+    dq->capacity = capacity;
+    dq->head = 0;
+}
+
 void initDeque(Deque* dq, size_t dataSize) {
-    initList(&dq->list, dataSize);
+    dq->buffer = NULL;
+    dq->dataSize = dataSize;
+    dq->capacity = 0;
+    dq->head = 0;
+    dq->size = 0;
 }
 
 int isDequeEmpty(Deque* dq) {
-    return isListEmpty(&dq->list);
+    return dq->size == 0;
+}
+
+int getDequeSize(Deque* dq) {
+    return (int)dq->size;
 }
 
 void pushFront(Deque* dq, void* item) {
-    prepend(&dq->list, item);
+    if (dq->size == dq->capacity) grow(dq);
+    dq->head = (dq->head - 1) & (dq->capacity - 1);
+    memcpy(slot(dq, 0), item, dq->dataSize);
+    dq->size++;
 }
 
 void pushBack(Deque* dq, void* item) {
-    append(&dq->list, item);
+    if (dq->size == dq->capacity) grow(dq);
+    memcpy(slot(dq, dq->size), item, dq->dataSize);
+    dq->size++;
 }
 
-void* popFront(Deque* dq) {
-    return removeFront(&dq->list);
+int popFront(Deque* dq, void* out) {
+    if (dq->size == 0) return 0;
+    if (out) memcpy(out, slot(dq, 0), dq->dataSize);
+    dq->head = (dq->head + 1) & (dq->capacity - 1);
+    dq->size--;
+    return 1;
 }
 
-void* popBack(Deque* dq) {
-    return removeBack(&dq->list);
+int popBack(Deque* dq, void* out) {
+    if (dq->size == 0) return 0;
+    dq->size--;
+    if (out) memcpy(out, slot(dq, dq->size), dq->dataSize);
+    return 1;
 }
 
 void* peekFront(Deque* dq) {
-    return getFront(&dq->list);
+    return dq->size ? slot(dq, 0) : NULL;
 }
 
 void* peekBack(Deque* dq) {
-    return getBack(&dq->list);
+    return dq->size ? slot(dq, dq->size - 1) : NULL;
 }
 
 void clearDeque(Deque* dq) {
-    clearList(&dq->list);
+    free(dq->buffer);
+    initDeque(dq, dq->dataSize);
 }
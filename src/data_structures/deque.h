@@ -1,18 +1,29 @@
 #pragma once
 #include <stddef.h>
-#include "linked_list.h"
 
+/*
+ * Double-ended queue on a growable power-of-two circular buffer.
+ * Items of dataSize bytes are copied in and stored contiguously, both ends
+ * are O(1) and nothing is allocated per item (the buffer doubles when full).
+ */
 typedef struct {
-    linked_list list;
+    char* buffer;
+    size_t dataSize;
+    size_t capacity; // Always a power of two, 0 until the first push
+    size_t head; // Index of the front item
+    size_t size;
 } Deque;
 
 // Deque API
 void initDeque(Deque* dq, size_t dataSize);
 int isDequeEmpty(Deque* dq);
+int getDequeSize(Deque* dq);
 void pushFront(Deque* dq, void* item);
 void pushBack(Deque* dq, void* item);
-void* popFront(Deque* dq);
-void* popBack(Deque* dq);
+// Pops copy the item into `out` (if not NULL), return 0 when the deque is empty
+int popFront(Deque* dq, void* out);
+int popBack(Deque* dq, void* out);
+// Peeks point into the buffer, valid until the next push or pop
 void* peekFront(Deque* dq);
 void* peekBack(Deque* dq);
-void clearDeque(Deque* dq);
\ No newline at end of file
+void clearDeque(Deque* dq);
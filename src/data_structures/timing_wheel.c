@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timing_wheel.h"
+
+#define TIMING_WHEEL_SLAB_NODES 256
+#define TIMING_WHEEL_MASK (TIMING_WHEEL_SLOTS - 1)
+// Farthest distance a level can hold, the last level's is the wheel's range
+#define LEVEL_RANGE(level) (1LL << (((level) + 1) * TIMING_WHEEL_BITS))
+
+static void grow(timing_wheel_t* wheel) {
+    timing_wheel_node_t* slab = malloc(sizeof(timing_wheel_node_t) * TIMING_WHEEL_SLAB_NODES);
+    void** slabs = realloc(wheel->slabs, sizeof(void*) * (wheel->slab_count + 1));
+    if (!slab || !slabs) {
+        perror("Failed to grow timing wheel");
+        exit(EXIT_FAILURE);
+    }
+    wheel->slabs = slabs;
+    wheel->slabs[wheel->slab_count++] = slab;
+
+    for (int i = 0; i < TIMING_WHEEL_SLAB_NODES; i++) {
+        slab[i].next = wheel->free_nodes;
+        wheel->free_nodes = &slab[i];
+    }
+}
+
+static timer_list_t* list_of(timing_wheel_t* wheel, timing_wheel_node_t* node) {
+    return node->level < 0 ? &wheel->due : &wheel->slots[node->level][node->slot];
+}
+
+static void link_tail(timer_list_t* list, timing_wheel_node_t* node) {
+    node->next = NULL;
+    node->prev = list->tail;
+    if (list->tail) list->tail->next = node;
+    else list->head = node;
+    list->tail = node;
+}
+
+static void unlink_node(timing_wheel_t* wheel, timing_wheel_node_t* node) {
+    timer_list_t* list = list_of(wheel, node);
+    if (node->prev) node->prev->next = node->next;
+    else list->head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list->tail = node->prev;
+
+    if (node->level >= 0 && !list->head)
+        wheel->bitmaps[node->level] &= ~(1ULL << node->slot);
+}
+
+// Files the node by its distance from now: due, or the level whose range holds it
+static void place(timing_wheel_t* wheel, timing_wheel_node_t* node) {
+    long long delta = (long long)node->expires - wheel->now;
+    if (delta <= 0) {
+        node->level = -1;
+        link_tail(&wheel->due, node);
+        return;
+    }
+
+    int level = 0;
+    while (level < TIMING_WHEEL_LEVELS - 1 && delta >= LEVEL_RANGE(level))
+        level++;
+    long long target = node->expires;
+    if (delta >= LEVEL_RANGE(level)) // Beyond the wheel, park it in the last slot it can reach
+        target = wheel->now + LEVEL_RANGE(level) - 1;
+
+    node->level = level;
+    node->slot = (int)((target >> (level * TIMING_WHEEL_BITS)) & TIMING_WHEEL_MASK);
+    link_tail(&wheel->slots[level][node->slot], node);
+    wheel->bitmaps[level] |= 1ULL << node->slot;
+}
+
+/*
+ * First non-empty slot of a level after the current one, in wheel order.
+ * Returns its absolute slot number (tick >> level bits), -1 if the level is empty.
+ */
+static long long next_slot(timing_wheel_t* wheel, int level) {
+    uint64_t bitmap = wheel->bitmaps[level];
+    if (!bitmap) return -1;
+    long long current = (long long)wheel->now >> (level * TIMING_WHEEL_BITS);
+    int start = (int)((current + 1) & TIMING_WHEEL_MASK);
+    uint64_t rotated = start ? (bitmap >> start) | (bitmap << (TIMING_WHEEL_SLOTS - start)) : bitmap;
+    return current + 1 + __builtin_ctzll(rotated);
+}
+
+// Next tick after now where a slot fires (level 0) or moves down (higher levels)
+static long long next_event_tick(timing_wheel_t* wheel) {
+    long long next = -1;
+    for (int level = 0; level < TIMING_WHEEL_LEVELS; level++) {
+        long long slot = next_slot(wheel, level);
+        if (slot < 0) continue;
+        long long tick = slot << (level * TIMING_WHEEL_BITS);
+        if (next < 0 || tick < next) next = tick;
+    }
+    return next;
+}
+
+// Moves the wheel to `tick`: cascades the slots starting there and makes level 0's slot due
+static void enter_tick(timing_wheel_t* wheel, int tick) {
+    wheel->now = tick;
+    for (int level = TIMING_WHEEL_LEVELS - 1; level > 0; level--) {
+        int shift = level * TIMING_WHEEL_BITS;
+        if (tick & ((1 << shift) - 1)) continue;
+        int slot = (tick >> shift) & TIMING_WHEEL_MASK;
+        timing_wheel_node_t* node = wheel->slots[level][slot].head;
+        wheel->slots[level][slot].head = wheel->slots[level][slot].tail = NULL;
+        wheel->bitmaps[level] &= ~(1ULL << slot);
+        while (node) {
+            timing_wheel_node_t* next = node->next;
+            place(wheel, node);
+            node = next;
+        }
+    }
+
+    int slot = tick & TIMING_WHEEL_MASK;
+    timer_list_t* list = &wheel->slots[0][slot];
+    if (!list->head) return;
+    for (timing_wheel_node_t* node = list->head; node; node = node->next)
+        node->level = -1;
+    // Append the whole slot to the due list
+    list->head->prev = wheel->due.tail;
+    if (wheel->due.tail) wheel->due.tail->next = list->head;
+    else wheel->due.head = list->head;
+    wheel->due.tail = list->tail;
+    list->head = list->tail = NULL;
+    wheel->bitmaps[0] &= ~(1ULL << slot);
+}
+
+static int fire_due(timing_wheel_t* wheel, timing_wheel_fire_t fire, void* context) {
+    int fired = 0;
+    timing_wheel_node_t* node;
+    while ((node = wheel->due.head) != NULL) {
+        void* data = node->data;
+        int expires = node->expires;
+        timing_wheel_cancel(wheel, node);
+        fire(data, expires, context);
+        fired++;
+    }
+    return fired;
+}
+
+timing_wheel_t* create_timing_wheel(int now) {
+    timing_wheel_t* wheel = malloc(sizeof(timing_wheel_t));
+    if (!wheel) {
+        perror("Failed to allocate timing wheel");
+        return NULL;
+    }
+    memset(wheel, 0, sizeof(timing_wheel_t));
+    wheel->now = now;
+    return wheel;
+}
+
+timing_wheel_node_t* timing_wheel_schedule(timing_wheel_t* wheel, int expires, void* data) {
+    if (!wheel->free_nodes) grow(wheel);
+    timing_wheel_node_t* node = wheel->free_nodes;
+    wheel->free_nodes = node->next;
+    node->data = data;
+    node->expires = expires;
+    place(wheel, node);
+    wheel->size++;
+    return node;
+}
+
+void timing_wheel_cancel(timing_wheel_t* wheel, timing_wheel_node_t* node) {
+    unlink_node(wheel, node);
+    wheel->size--;
+    node->next = wheel->free_nodes;
+    wheel->free_nodes = node;
+}
+
+int timing_wheel_advance(timing_wheel_t* wheel, int until, timing_wheel_fire_t fire, void* context) {
+    int fired = fire_due(wheel, fire, context);
+    while (wheel->now < until) {
+        long long next = next_event_tick(wheel);
+        if (next < 0 || next > until) next = until; // Nothing fires before `until`
+        enter_tick(wheel, (int)next);
+        fired += fire_due(wheel, fire, context);
+    }
+    return fired;
+}
+
+int timing_wheel_next_expiry(timing_wheel_t* wheel) {
+    if (wheel->due.head) return wheel->now;
+
+    long long next = -1;
+    for (int level = 0; level < TIMING_WHEEL_LEVELS; level++) {
+        long long slot = next_slot(wheel, level);
+        if (slot < 0) continue;
+        long long tick = slot << (level * TIMING_WHEEL_BITS);
+        if (level > 0) {
+            // A higher slot spans many ticks, its earliest timer is the candidate
+            timing_wheel_node_t* node = wheel->slots[level][slot & TIMING_WHEEL_MASK].head;
+            tick = node->expires;
+            for (node = node->next; node; node = node->next)
+                if (node->expires < tick) tick = node->expires;
+        }
+        if (next < 0 || tick < next) next = tick;
+    }
+    return (int)next;
+}
+
+int timing_wheel_is_empty(timing_wheel_t* wheel) {
+    return wheel->size == 0;
+}
+
+int timing_wheel_size(timing_wheel_t* wheel) {
+    return wheel->size;
+}
+
+void destroy_timing_wheel(timing_wheel_t* wheel) {
+    for (int i = 0; i < wheel->slab_count; i++)
+        free(wheel->slabs[i]);
+    free(wheel->slabs);
+    free(wheel);
+}
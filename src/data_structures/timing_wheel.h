@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Hierarchical timing wheel of "fire at tick T" timers.
+ * Level L has 64 slots of 64^L ticks each, a timer sits in the level its
+ * distance from `now` falls in and is moved down one level when the wheel
+ * reaches its slot, so schedule and cancel are O(1) and advancing fires a
+ * whole tick's batch at once. Per-level bitmaps of non-empty slots let the
+ * wheel jump over empty ticks. The timers of one tick fire as a batch in no
+ * particular order, callers needing an order within a tick sort the batch.
+ */
+#define TIMING_WHEEL_BITS 6
+#define TIMING_WHEEL_SLOTS (1 << TIMING_WHEEL_BITS)
+#define TIMING_WHEEL_LEVELS 5 // 2^30 ticks, farther timers wait in the last level
+
+typedef struct timing_wheel_node {
+    void* data;
+    int expires;
+    int level; // -1 while due
+    int slot;
+    struct timing_wheel_node* prev;
+    struct timing_wheel_node* next;
+} timing_wheel_node_t;
+
+typedef struct {
+    timing_wheel_node_t* head;
+    timing_wheel_node_t* tail;
+} timer_list_t;
+
+typedef struct timing_wheel {
+    timer_list_t slots[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS];
+    uint64_t bitmaps[TIMING_WHEEL_LEVELS]; // Bit i is set when slots[level][i] is not empty
+    timer_list_t due; // Expired timers not fired yet
+    int now; // Last tick the wheel advanced to
+    int size;
+    timing_wheel_node_t* free_nodes; // Recycled nodes, linked through next
+    void** slabs;
+    int slab_count;
+} timing_wheel_t;
+
+typedef void (*timing_wheel_fire_t)(void* data, int expires, void* context);
+
+timing_wheel_t* create_timing_wheel(int now);
+/*
+ * Schedules `data` to fire at tick `expires`, a tick at or before `now` fires
+ * on the next advance. The returned node can be cancelled until it fires.
+ */
+timing_wheel_node_t* timing_wheel_schedule(timing_wheel_t* wheel, int expires, void* data);
+void timing_wheel_cancel(timing_wheel_t* wheel, timing_wheel_node_t* node);
+/*
+ * Moves the wheel to tick `until` and fires every timer expiring at or before
+ * it, tick by tick. Timers scheduled from `fire` for a tick that already came
+ * fire within the same call. Returns the number of timers fired.
+ */
+int timing_wheel_advance(timing_wheel_t* wheel, int until, timing_wheel_fire_t fire, void* context);
+// Tick of the earliest timer (`now` if one is due), -1 when the wheel is empty
+int timing_wheel_next_expiry(timing_wheel_t* wheel);
+int timing_wheel_is_empty(timing_wheel_t* wheel);
+int timing_wheel_size(timing_wheel_t* wheel);
+void destroy_timing_wheel(timing_wheel_t* wheel);
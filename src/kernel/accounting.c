@@ -0,0 +1,85 @@
+#include "accounting.h"
+#include "headers.h"
+#include "text_format.h"
+
+extern finishedProcessInfo** finished_process_info;
+extern int finished_processes_count;
+
+static long long account_running_ticks = 0; // Every process's running ticks, the rest of the run the CPU idled
+
+void account_enter(process_account_t* account, int arrival_time, int state, int time)
+{
+    if (account->state == ACCOUNT_FINISHED)
+        return;
+
+    int from = account->since > arrival_time ? account->since : arrival_time;
+    int elapsed = time > from ? time - from : 0;
+    account->ticks[account->state] += elapsed;
+    if (account->state == ACCOUNT_RUNNING)
+        account_running_ticks += elapsed;
+
+    if (state == ACCOUNT_RUNNING)
+        account->dispatches++;
+    account->state = state;
+    account->since = time;
+}
+
+void account_preempt(process_account_t* account, int arrival_time, int time)
+{
+    if (account->state == ACCOUNT_FINISHED)
+        return;
+    account_enter(account, arrival_time, ACCOUNT_STOPPED, time);
+    account->preemptions++;
+}
+
+void write_account_stats(FILE* perf_file, int total_execution_time)
+{
+    double state_ticks[ACCOUNT_STATES] = {0};
+    double response = 0, dispatches = 0, preemptions = 0;
+    int count = 0;
+    for (int i = 0; i < finished_processes_count; i++)
+    {
+        finishedProcessInfo* info = finished_process_info[i];
+        if (!info)
+            continue;
+        for (int s = 0; s < ACCOUNT_STATES; s++)
+            state_ticks[s] += info->account.ticks[s];
+        response += info->response_time;
+        dispatches += info->account.dispatches;
+        preemptions += info->account.preemptions;
+        count++;
+    }
+    if (count == 0)
+        return;
+
+    long long idle = total_execution_time - account_running_ticks;
+    fprintf(perf_file, "Avg ready = %.2f\n", state_ticks[ACCOUNT_READY] / count);
+    fprintf(perf_file, "Avg running = %.2f\n", state_ticks[ACCOUNT_RUNNING] / count);
+    fprintf(perf_file, "Avg blocked = %.2f\n", state_ticks[ACCOUNT_BLOCKED] / count);
+    fprintf(perf_file, "Avg stopped = %.2f\n", state_ticks[ACCOUNT_STOPPED] / count);
+    fprintf(perf_file, "Avg response = %.2f\n", response / count);
+    fprintf(perf_file, "Avg dispatches = %.2f\n", dispatches / count);
+    fprintf(perf_file, "Avg preemptions = %.2f\n", preemptions / count);
+    fprintf(perf_file, "Idle ticks = %lld\n", idle > 0 ? idle : 0);
+
+    fprintf(perf_file, "#process\tarrival\tfinish\tready\trunning\tblocked\tstopped\tresponse\tdispatches\tpreemptions\n");
+    for (int i = 0; i < finished_processes_count; i++)
+    {
+        finishedProcessInfo* info = finished_process_info[i];
+        if (!info)
+            continue;
+        int fields[] = {info->id, info->arrival_time, info->arrival_time + info->ta,
+                        info->account.ticks[ACCOUNT_READY], info->account.ticks[ACCOUNT_RUNNING],
+                        info->account.ticks[ACCOUNT_BLOCKED], info->account.ticks[ACCOUNT_STOPPED],
+                        info->response_time, info->account.dispatches, info->account.preemptions};
+        int columns = sizeof(fields) / sizeof(fields[0]);
+        char row[128];
+        char* end = row;
+        for (int f = 0; f < columns; f++)
+        {
+            end = format_int(end, fields[f]);
+            *end++ = f + 1 < columns ? '\t' : '\n';
+        }
+        fwrite(row, 1, end - row, perf_file);
+    }
+}
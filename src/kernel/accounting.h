@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdio.h>
+
+/*
+ * Per-process, per-state time accounting.
+ * Every state change the scheduler logs closes the ticks of the state the
+ * process leaves, so a finished process's ready, running, blocked and stopped
+ * ticks add up to its turnaround time under every engine and policy, and its
+ * ready plus stopped ticks are its waiting time (Avg Waiting).
+ */
+#define ACCOUNT_FINISHED -1
+#define ACCOUNT_READY 0 // Arrived and waiting for memory or the CPU, or back from I/O
+#define ACCOUNT_RUNNING 1
+#define ACCOUNT_BLOCKED 2 // Waiting for or using an I/O device
+#define ACCOUNT_STOPPED 3 // Preempted and waiting to resume
+#define ACCOUNT_STATES 4
+
+typedef struct
+{
+    int ticks[ACCOUNT_STATES];
+    int dispatches;
+    int preemptions; // Stopped before its CPU burst ended: RR quantum or SRTN preemption
+    int state; // Starts zeroed, ready since the arrival
+    int since; // Tick it entered `state`, its arrival until the first change
+} process_account_t;
+
+// Moves the process to `state` at `time`, counting a dispatch when it is one
+void account_enter(process_account_t* account, int arrival_time, int state, int time);
+// Moves a preempted process to ACCOUNT_STOPPED at `time` and counts the preemption
+void account_preempt(process_account_t* account, int arrival_time, int time);
+/*
+ * Appends the mean ticks per state, response time, dispatches and
+ * preemptions over the finished processes, the CPU's idle ticks, and then
+ * one row per finished process.
+ */
+void write_account_stats(FILE* perf_file, int total_execution_time);
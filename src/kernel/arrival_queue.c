@@ -0,0 +1,178 @@
+#include "arrival_queue.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/msg.h>
+#include "latency.h"
+#include "clk.h"
+#include "logging.h"
+#include "futex.h"
+
+static arrival_queue_t intake_queue;
+static pthread_t intake_thread;
+static int intake_running = 0;
+static int intake_msgid = -1;
+static int intake_closed = 0; // Written by the intake thread, read by the dispatch thread
+static int intake_bell = 0; // Bumped after every publish and at closing, the dispatch thread sleeps on it
+static int intake_through = -1; // Tick of the latest marker, written by the intake thread
+
+void arrival_queue_init(arrival_queue_t* queue)
+{
+    queue->stub.next = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+}
+
+void arrival_queue_push(arrival_queue_t* queue, arrival_t* arrival)
+{
+    __atomic_store_n(&arrival->next, NULL, __ATOMIC_RELAXED);
+    arrival_t* prev = __atomic_exchange_n(&queue->head, arrival, __ATOMIC_ACQ_REL);
+    // Until this store the consumer sees the list end at prev
+    __atomic_store_n(&prev->next, arrival, __ATOMIC_RELEASE);
+}
+
+arrival_t* arrival_queue_pop(arrival_queue_t* queue)
+{
+    arrival_t* tail = queue->tail;
+    arrival_t* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (tail == &queue->stub)
+    {
+        if (next == NULL)
+            return NULL;
+        queue->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+
+    // tail looks like the last node, a producer may be between its exchange and its link
+    if (tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+        return NULL;
+    // Put the stub behind tail so tail can leave without emptying the list
+    arrival_queue_push(queue, &queue->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next)
+    {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static void ring_intake_bell()
+{
+    __atomic_add_fetch(&intake_bell, 1, __ATOMIC_RELEASE);
+    futex_wake_all(&intake_bell);
+}
+
+// Blocks until one message is in the intake queue or a tick marker is published, returns -1 once the queue is gone
+static int receive_arrival()
+{
+    arrival_t* arrival = (arrival_t*)malloc(sizeof(arrival_t));
+    if (!arrival)
+    {
+        perror("Failed to allocate memory for arrival");
+        return 0;
+    }
+    // The size counts the payload after mtype, type 0 takes arrivals and markers in the order they were sent
+    if (msgrcv(intake_msgid, &arrival->pcb, sizeof(PCB) - sizeof(long), 0, 0) == -1)
+    {
+        int error = errno;
+        free(arrival);
+        if (error == EINTR)
+            return 0;
+        // EIDRM: the generator removed the queue, EINVAL: it was already gone
+        if (error != EIDRM && error != EINVAL)
+            LOG(LOG_SCHEDULER, LOG_ERROR, "[SCHEDULER] Error receiving message: %s\n", strerror(error));
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Message queue has been closed or removed, intake stopped\n");
+        __atomic_store_n(&intake_closed, 1, __ATOMIC_RELEASE);
+        ring_intake_bell();
+        return -1;
+    }
+    if (arrival->pcb.mtype == ARRIVALS_THROUGH_MSG)
+    {
+        // Every arrival up to the marker's tick was pushed before it, the release publishes them with it
+        __atomic_store_n(&intake_through, arrival->pcb.arrival_time, __ATOMIC_RELEASE);
+        free(arrival);
+        ring_intake_bell();
+        return 1;
+    }
+    LATENCY_RECORD(LATENCY_QUEUE, arrival->pcb.sent_ns);
+    LOG(LOG_SCHEDULER, LOG_DEBUG,
+        "[SCHEDULER] Received process ID: %d, arrival time: %d, remaining_time: %d at %d\n", arrival->pcb.pid,
+        arrival->pcb.arrival_time, arrival->pcb.remaining_time, get_clk());
+    arrival_queue_push(&intake_queue, arrival);
+    ring_intake_bell();
+    return 1;
+}
+
+static void* intake_loop(void* unused)
+{
+    (void)unused;
+    while (receive_arrival() != -1)
+        ;
+    return NULL;
+}
+
+int start_arrival_intake(int msgid)
+{
+    arrival_queue_init(&intake_queue);
+    intake_msgid = msgid;
+    intake_closed = 0;
+    intake_through = -1;
+
+    // The thread inherits the mask, the signal handlers must run on the dispatch thread
+    sigset_t mask, previous;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &mask, &previous);
+    int error = pthread_create(&intake_thread, NULL, intake_loop, NULL);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (error)
+    {
+        LOG(LOG_SCHEDULER, LOG_ERROR, "[SCHEDULER] Failed to start the intake thread: %s\n", strerror(error));
+        return -1;
+    }
+    intake_running = 1;
+    return 0;
+}
+
+arrival_t* take_arrival()
+{
+    return arrival_queue_pop(&intake_queue);
+}
+
+int* arrival_bell()
+{
+    return &intake_bell;
+}
+
+int arrivals_closed()
+{
+    return __atomic_load_n(&intake_closed, __ATOMIC_ACQUIRE);
+}
+
+int arrivals_through()
+{
+    return __atomic_load_n(&intake_through, __ATOMIC_ACQUIRE);
+}
+
+void stop_arrival_intake()
+{
+    if (!intake_running)
+        return;
+
+    pthread_join(intake_thread, NULL);
+    intake_running = 0;
+    arrival_t* arrival;
+    while ((arrival = take_arrival()) != NULL)
+        free(arrival);
+}
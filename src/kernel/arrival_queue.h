@@ -0,0 +1,54 @@
+#pragma once
+
+#include "pcb.h"
+
+/*
+ * Arrival intake of the multi-process engine.
+ * An intake thread blocks in msgrcv() on the generator's queue and pushes every
+ * PCB it receives onto a lock-free multi-producer, single-consumer queue; the
+ * dispatch thread pops them at its decision points without a system call.
+ */
+
+/*
+ * mtype of the generator's tick marker, a PCB whose arrival_time is the last
+ * tick it sent every arrival of. The generator sends one after the arrivals of
+ * each tick it wakes up at, so the scheduler knows when a tick is complete.
+ */
+#define ARRIVALS_THROUGH_MSG 2
+
+typedef struct arrival
+{
+    struct arrival* next;
+    PCB pcb;
+} arrival_t;
+
+// Intrusive MPSC queue, producers only swap the head, the consumer alone follows the tail
+typedef struct
+{
+    arrival_t* head; // Last pushed
+    arrival_t* tail; // Next to pop
+    arrival_t stub; // Keeps the list non-empty so push and pop never meet on one node
+} arrival_queue_t;
+
+void arrival_queue_init(arrival_queue_t* queue);
+// Safe from any number of threads at once
+void arrival_queue_push(arrival_queue_t* queue, arrival_t* arrival);
+// Consumer only, NULL when empty or while a push is half done
+arrival_t* arrival_queue_pop(arrival_queue_t* queue);
+
+// Starts the intake thread on the message queue, SIGCHLD and SIGINT stay with the calling thread
+int start_arrival_intake(int msgid);
+// Oldest arrival the intake thread published, the caller frees it
+arrival_t* take_arrival();
+/*
+ * Word the intake thread bumps and wakes after each arrival it publishes and
+ * once the queue closed. Read it before draining with take_arrival(), then
+ * sleep on that value so an arrival published in between is not slept through.
+ */
+int* arrival_bell();
+// Set once the message queue is removed, every arrival before it is already published
+int arrivals_closed();
+// Last tick every arrival of is already published, from the generator's latest tick marker
+int arrivals_through();
+// Joins the intake thread after the queue closed and frees arrivals nobody took
+void stop_arrival_intake();
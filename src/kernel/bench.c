@@ -0,0 +1,29 @@
+#ifdef OS_SIM_BENCH
+
+#include "bench.h"
+#include <stdio.h>
+
+bench_probe_t bench_probes[BENCH_PROBES];
+
+static const char* const bench_probe_names[BENCH_PROBES] = {"decision", "enqueue"};
+
+void write_bench_report(int ticks)
+{
+    FILE* bench_file = fopen("scheduler.bench", "w");
+    if (!bench_file)
+    {
+        perror("Failed to open bench file");
+        return;
+    }
+
+    fprintf(bench_file, "ticks %d\n", ticks);
+    for (int i = 0; i < BENCH_PROBES; i++)
+    {
+        bench_probe_t* probe = &bench_probes[i];
+        fprintf(bench_file, "%s %lld %lld %lld\n", bench_probe_names[i], probe->count,
+                probe->count ? probe->total_ns / probe->count : 0, probe->max_ns);
+    }
+    fclose(bench_file);
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Overhead probes for the benchmark build (make bench, -DOS_SIM_BENCH).
+ * In normal builds every macro compiles to nothing.
+ */
+#ifdef OS_SIM_BENCH
+
+#include <time.h>
+
+// Probes
+#define BENCH_DECISION 0 // Time spent in hpf()/srtn()/rr()
+#define BENCH_ENQUEUE 1 // Arrival message sent (DES: arrival event taken) to PCB in the ready queue
+#define BENCH_PROBES 2
+
+typedef struct
+{
+    long long count;
+    long long total_ns;
+    long long max_ns;
+} bench_probe_t;
+
+extern bench_probe_t bench_probes[BENCH_PROBES];
+
+static inline long long bench_now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static inline void bench_record(int probe, long long elapsed_ns)
+{
+    bench_probe_t* p = &bench_probes[probe];
+    p->count++;
+    p->total_ns += elapsed_ns;
+    if (elapsed_ns > p->max_ns)
+        p->max_ns = elapsed_ns;
+}
+
+#define BENCH_START(start) long long start = bench_now_ns()
+#define BENCH_STOP(probe, start) bench_record(probe, bench_now_ns() - (start))
+
+/*
+ * Writes scheduler.bench: the simulated tick count and, per probe,
+ * the number of samples and the mean and max latency in nanoseconds.
+ */
+void write_bench_report(int ticks);
+
+#else
+
+#define BENCH_START(start)
+#define BENCH_STOP(probe, start)
+#define write_bench_report(ticks)
+
+#endif
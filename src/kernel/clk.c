@@ -11,8 +11,14 @@
 #include <unistd.h>
 #include "clk.h"
 #include "colors.h"
+#include "logging.h"
+#include "ipc_keys.h"
+#include "futex.h"
 
 #define SHKEY 300
+// Default tick length in microseconds, OS_SIM_TICK_US overrides it
+#define DEFAULT_TICK_US 1000000
+#define SYNC_POLLS_PER_TICK 10 // sync_clk() attaches at most a tenth of a tick after the clock exists
 ///==============================
 // don't mess with this variable//
 int* shmaddr = NULL; //
@@ -24,17 +30,17 @@ int shmid;
 void _cleanup(__attribute__((unused)) int signum)
 {
     shmctl(shmid, IPC_RMID, NULL);
-    printf(ANSI_COLOR_CYAN"[CLOCK] Clock terminating!\n"ANSI_COLOR_RESET);
+    LOG(LOG_CLOCK, LOG_INFO, "[CLOCK] Clock terminating!\n");
     exit(0);
 }
 
 void init_clk()
 {
-    printf(ANSI_COLOR_CYAN"[CLOCK] Clock starting\n"ANSI_COLOR_RESET);
+    LOG(LOG_CLOCK, LOG_INFO, "[CLOCK] Clock starting\n");
     signal(SIGINT, _cleanup);
     int clk = 0;
     // Create shared memory for one integer variable 4 bytes
-    shmid = shmget(SHKEY, 4, IPC_CREAT | 0644);
+    shmid = shmget(ipc_key(SHKEY), 4, IPC_CREAT | 0644);
     if ((long)shmid == -1)
     {
         perror("Error in creating shm!");
@@ -49,13 +55,22 @@ void init_clk()
     *shmaddr = clk; /* initialize shared memory */
 }
 
+static useconds_t clk_tick_us()
+{
+    const char* tick_env = getenv("OS_SIM_TICK_US");
+    useconds_t tick_us = tick_env ? (useconds_t)atol(tick_env) : DEFAULT_TICK_US;
+    return tick_us ? tick_us : DEFAULT_TICK_US;
+}
+
 void run_clk()
 {
+    useconds_t tick_us = clk_tick_us();
     while (1)
     {
-        printf(ANSI_COLOR_CYAN"[CLOCK] current time is %d\n"ANSI_COLOR_RESET, (*shmaddr));
-        sleep(1);
-        (*shmaddr)++;
+        LOG(LOG_CLOCK, LOG_TRACE, "[CLOCK] current time is %d\n", (*shmaddr));
+        usleep(tick_us);
+        __atomic_add_fetch(shmaddr, 1, __ATOMIC_RELEASE);
+        futex_wake_all(shmaddr); // Processes sleeping in wait_clk()
     }
 }
 
@@ -70,16 +85,35 @@ int get_clk()
         return *shmaddr;
 }
 
+int wait_clk(int tick)
+{
+    if (shmaddr == NULL)
+    {
+        perror("[CLOCK] SHMADDR IS BEING ACCESSED ALTHOUGH NULL");
+        return -1;
+    }
+    int now;
+    while ((now = __atomic_load_n(shmaddr, __ATOMIC_ACQUIRE)) < tick)
+        futex_wait(shmaddr, now, NULL);
+    return now;
+}
+
+int* clk_word()
+{
+    return shmaddr;
+}
+
 void sync_clk()
 {
-    int shmidLocal = shmget(SHKEY, 4, 0444);
+    // Attaching late would skew every start time
+    useconds_t poll_us = clk_tick_us() / SYNC_POLLS_PER_TICK;
+    int shmidLocal = shmget(ipc_key(SHKEY), 4, 0444);
     while ((int)shmidLocal == -1)
     {
         // Make sure that the clock exists
-        if(DEBUG)
-        printf(ANSI_COLOR_CYAN"[CLOCK] Wait! The clock not initialized yet!\n"ANSI_COLOR_RESET);
-        sleep(1);
-        shmidLocal = shmget(SHKEY, 4, 0444);
+        LOG(LOG_SHARED_MEM, LOG_DEBUG, "[CLOCK] Wait! The clock not initialized yet!\n");
+        usleep(poll_us ? poll_us : 1);
+        shmidLocal = shmget(ipc_key(SHKEY), 4, 0444);
     }
     shmaddr = (int*)shmat(shmidLocal, (void*)0, 0);
 }
@@ -8,13 +8,22 @@
 void init_clk();
 /*
  * This function is used to run the clock module.
- * It increments the clock value every second.
+ * It increments the clock value every second, or every OS_SIM_TICK_US microseconds when that is set.
  */
 void run_clk();
 /*
  *This function is used to get the clock value from the shared memory
  */
 int get_clk();
+/*
+ * Sleeps until the clock reaches `tick` instead of polling get_clk(), the clock wakes the sleepers every tick.
+ * Returns the clock value it woke up to.
+ */
+int wait_clk(int tick);
+/*
+ * Address of the shared clock value, for sleeping on it along with other futex words.
+ */
+int* clk_word();
 /*
  * All process call this function at the beginning to establish communication between them and the clock module.
  * Again, remember that the clock is only emulation!
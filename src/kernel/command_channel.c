@@ -0,0 +1,148 @@
+#include "command_channel.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include "colors.h"
+#include "logging.h"
+#include "futex.h"
+#include "ipc_keys.h"
+#include "latency.h"
+
+channel_table_t* channel_table = NULL;
+int channel_shm_id = -1;
+static int next_claim = 0; // Generator's scan position
+
+/*
+ * Creates the channel table in shared memory, before the fork so the
+ * generator and the scheduler share the mapping.
+ */
+channel_table_t* create_channel_table()
+{
+    channel_shm_id = shmget(ipc_key(CHANNEL_SHM_KEY), sizeof(channel_table_t), IPC_CREAT | 0666);
+    if (channel_shm_id == -1)
+    {
+        perror("Error creating command channel shared memory");
+        return NULL;
+    }
+
+    channel_table_t* table = (channel_table_t*)shmat(channel_shm_id, NULL, 0);
+    if ((void*)table == (void*)-1)
+    {
+        perror("Error attaching command channel shared memory");
+        shmctl(channel_shm_id, IPC_RMID, NULL);
+        channel_shm_id = -1;
+        return NULL;
+    }
+    memset(table, 0, sizeof(channel_table_t));
+    table->last_rung = -1;
+    return table;
+}
+
+int channel_claim(channel_table_t* table)
+{
+    while (1)
+    {
+        for (int i = 0; i < MAX_CHANNELS; i++)
+        {
+            int channel = (next_claim + i) % MAX_CHANNELS;
+            command_channel_t* entry = &table->channels[channel];
+            if (__atomic_load_n(&entry->in_use, __ATOMIC_ACQUIRE))
+                continue;
+
+            entry->command = CHANNEL_NONE;
+            entry->acked = entry->doorbell;
+            entry->state = CHANNEL_IDLE;
+            entry->ran = 0;
+            __atomic_store_n(&entry->in_use, 1, __ATOMIC_RELEASE);
+            next_claim = channel + 1;
+            return channel;
+        }
+        // Every channel belongs to a live process, wait for the scheduler to release one
+        usleep(1000);
+    }
+}
+
+static int ring(channel_table_t* table, int channel, int command, int ticks, int clk)
+{
+    command_channel_t* entry = &table->channels[channel];
+    entry->command = command;
+    entry->ticks = ticks;
+    entry->posted_clk = clk;
+    // Publish the command before the doorbell, the process reads it once it sees the new value
+    int seq = __atomic_add_fetch(&entry->doorbell, 1, __ATOMIC_RELEASE);
+    futex_wake_all(&entry->doorbell);
+
+    table->last_rung = channel;
+    __atomic_add_fetch(&table->bell, 1, __ATOMIC_RELEASE);
+    futex_wake_all(&table->bell);
+    return seq;
+}
+
+void channel_run(channel_table_t* table, int channel, int ticks, int clk)
+{
+#ifdef OS_SIM_LATENCY
+    command_channel_t* entry = &table->channels[channel];
+    entry->observed_ns = 0;
+    entry->acked_ns = 0;
+    entry->hops_pending = 1;
+    LATENCY_STAMP(entry->posted_ns);
+#endif
+    ring(table, channel, CHANNEL_RUN, ticks, clk);
+}
+
+int channel_busy(channel_table_t* table, int channel)
+{
+    command_channel_t* entry = &table->channels[channel];
+    int busy = __atomic_load_n(&entry->acked, __ATOMIC_ACQUIRE) != __atomic_load_n(&entry->doorbell, __ATOMIC_ACQUIRE);
+#ifdef OS_SIM_LATENCY
+    // The first look at an acknowledged RUN closes its dispatch and completion hops
+    if (!busy && entry->hops_pending)
+    {
+        entry->hops_pending = 0;
+        latency_record(LATENCY_DISPATCH, entry->posted_ns, entry->observed_ns);
+        LATENCY_RECORD(LATENCY_COMPLETION, entry->acked_ns);
+    }
+#endif
+    return busy;
+}
+
+void channel_stop(channel_table_t* table, int channel)
+{
+    command_channel_t* entry = &table->channels[channel];
+#ifdef OS_SIM_LATENCY
+    entry->hops_pending = 0;
+#endif
+    int seq = ring(table, channel, CHANNEL_STOP, 0, -1);
+    /*
+     * A process that used up its runtime sets CHANNEL_DONE before its last
+     * acknowledgement and serves nothing after it, so the stop is answered by
+     * that acknowledgement instead. Either one wakes this sleep.
+     */
+    int acked;
+    while ((acked = __atomic_load_n(&entry->acked, __ATOMIC_ACQUIRE)) != seq &&
+           __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) != CHANNEL_DONE)
+        futex_wait(&entry->acked, acked, NULL);
+}
+
+void channel_release(channel_table_t* table, int channel)
+{
+    if (table && channel >= 0)
+        __atomic_store_n(&table->channels[channel].in_use, 0, __ATOMIC_RELEASE);
+}
+
+void destroy_channel_table(channel_table_t* table)
+{
+    if (table == NULL) return;
+
+    for (int i = 0; i < MAX_CHANNELS; i++)
+        if (table->channels[i].in_use && table->channels[i].state != CHANNEL_DONE)
+            ring(table, i, CHANNEL_EXIT, 0, -1);
+
+    shmdt(table);
+    // Processes keep their mapping, the segment goes once the last one detaches
+    shmctl(channel_shm_id, IPC_RMID, NULL);
+    channel_shm_id = -1;
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[SCHEDULER] Command channels removed\n");
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#define CHANNEL_SHM_KEY 800
+#define MAX_CHANNELS 65536 // Live processes at once, the generator waits for a free channel beyond that
+
+// Commands the scheduler rings on a channel
+#define CHANNEL_NONE 0
+#define CHANNEL_RUN 1 // Run `ticks` ticks from tick `posted_clk`
+#define CHANNEL_STOP 2 // Descheduled, stop at the next tick boundary
+#define CHANNEL_EXIT 3 // Exit without finishing
+
+// States the process reports
+#define CHANNEL_IDLE 0 // Waiting for a command
+#define CHANNEL_RUNNING 1
+#define CHANNEL_STOPPED 2
+#define CHANNEL_DONE 3 // Used up its runtime, set before its last acknowledgement (its first with no runtime)
+
+/*
+ * Command channel of one process, claimed by the generator when it starts the
+ * process and released by the scheduler once the process finished.
+ * The scheduler writes the command and bumps `doorbell`, waking the process
+ * sleeping on it; the process carries the command out and sets `acked` to that
+ * doorbell value, waking the scheduler when it waits for the acknowledgement.
+ * A command is pending while acked != doorbell.
+ */
+typedef struct
+{
+    int in_use;
+    int doorbell;
+    int command;
+    int ticks;
+    int posted_clk;
+    int acked;
+    int state;
+    int ran; // Ticks the last RUN lasted, fewer than asked when stopped early
+#ifdef OS_SIM_LATENCY
+    long long posted_ns; // Scheduler rang the last RUN
+    long long observed_ns; // Process took it
+    long long acked_ns; // Process acknowledged it
+    int hops_pending; // Scheduler side, the RUN's hops are not recorded yet
+#endif
+} command_channel_t;
+
+typedef struct
+{
+    int bell; // Bumped with every command on any channel, the coroutine host sleeps on it
+    int last_rung; // Channel of the latest command
+    command_channel_t channels[MAX_CHANNELS];
+} channel_table_t;
+
+extern channel_table_t* channel_table;
+
+channel_table_t* create_channel_table();
+// Claims a free channel for a new process (generator side), waiting while every channel is taken
+int channel_claim(channel_table_t* table);
+// Rings a RUN of `ticks` ticks
+void channel_run(channel_table_t* table, int channel, int ticks, int clk);
+// Whether the process has not acknowledged the last command yet
+int channel_busy(channel_table_t* table, int channel);
+// Rings a STOP and waits until the process acknowledges it or has finished
+void channel_stop(channel_table_t* table, int channel);
+void channel_release(channel_table_t* table, int channel);
+// Rings EXIT on every channel still in use and removes the table
+void destroy_channel_table(channel_table_t* table);
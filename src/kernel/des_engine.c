@@ -0,0 +1,375 @@
+/*
+ * Discrete-event simulation engine.
+ * Runs the same policies, logging and statistics as the multi-process
+ * scheduler from an event calendar inside one process: no fork, signals,
+ * shared memory or wall-clock ticks.
+ */
+#include "des_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "colors.h"
+#include "logging.h"
+#include "headers.h"
+#include <stdint.h>
+#include "timing_wheel.h"
+#include "ready_queue.h"
+#include "pcb.h"
+#include "deque.h"
+#include "scheduler.h"
+#include "scheduler_utils.h"
+#include "bench.h"
+#include "memory_manager.h"
+#include "paging.h"
+#include "io_devices.h"
+#include "metrics_page.h"
+
+extern int scheduler_type;
+extern int quantum;
+extern int total_busy_time;
+extern int flush_log_lines;
+
+// Event types, the timers of the calendar carry the type as their data
+#define EVENT_ARRIVAL 0
+#define EVENT_SLICE_END 1
+#define EVENT_IO_DONE 2
+#define EVENT_TYPES 3
+
+static timing_wheel_t* calendar = NULL;
+// Events of the current tick fired by the calendar but not handled yet, per type
+static int pending_events[EVENT_TYPES];
+
+// Arrivals are streamed from the workload, only the next one is in the calendar
+static workload_reader_t* des_workload = NULL;
+static processParameters next_arrival;
+
+static ready_queue_t* des_heap_queue = NULL;
+static Deque* des_rr_queue = NULL; // PCB pointers
+
+// Dispatch state of the running process
+static int slice_start = 0; // Time the process was dispatched
+static int slice_length = 0; // HPF: ticks until the pending slice end
+static int dispatched_remaining = 0; // SRTN: remaining time when dispatched, plus fault service charged since
+static int units_ran = 0; // SRTN: units completed since dispatch
+static int preempt = 0; // SRTN: a shorter process arrived during this dispatch
+
+static int io_event_time = -1; // Latest I/O completion put in the calendar
+
+/*
+ * Within one tick the multi-process scheduler re-enqueues an RR process whose
+ * quantum expired before it receives the tick's arrivals, while HPF and SRTN
+ * see those arrivals before picking the next process or deciding to preempt.
+ * Processes back from I/O are taken in just before the arrivals.
+ */
+static const int* event_sequence()
+{
+    static const int rr_sequence[EVENT_TYPES] = {EVENT_SLICE_END, EVENT_IO_DONE, EVENT_ARRIVAL};
+    static const int sequence[EVENT_TYPES] = {EVENT_IO_DONE, EVENT_ARRIVAL, EVENT_SLICE_END};
+    return scheduler_type == RR ? rr_sequence : sequence;
+}
+
+static void schedule_event(int time, int type)
+{
+    timing_wheel_schedule(calendar, time, (void*)(intptr_t)type);
+}
+
+static void collect_event(void* data, int expires, void* context)
+{
+    (void)expires;
+    (void)context;
+    pending_events[(intptr_t)data]++;
+}
+
+// Takes the first pending event of the tick in event_sequence() order, -1 when none is left
+static int take_pending_event()
+{
+    const int* sequence = event_sequence();
+    for (int i = 0; i < EVENT_TYPES; i++)
+        if (pending_events[sequence[i]])
+        {
+            pending_events[sequence[i]]--;
+            return sequence[i];
+        }
+    return -1;
+}
+
+static void make_ready(PCB* process)
+{
+    if (scheduler_type == RR)
+        pushBack(des_rr_queue, &process);
+    else
+        ready_queue_insert(des_heap_queue, process);
+}
+
+static int ready_queue_empty()
+{
+    if (scheduler_type == RR)
+        return isDequeEmpty(des_rr_queue);
+    return ready_queue_is_empty(des_heap_queue);
+}
+
+static int ready_depth()
+{
+    if (scheduler_type == RR)
+        return (int)des_rr_queue->size;
+    return ready_queue_size(des_heap_queue);
+}
+
+// Queues the arrival of the next record, never earlier than `now`
+static void schedule_next_arrival(int now)
+{
+    if (!workload_next(des_workload, &next_arrival))
+        return;
+    if (next_arrival.arrival_time < now)
+        next_arrival.arrival_time = now;
+    schedule_event(next_arrival.arrival_time, EVENT_ARRIVAL);
+}
+
+// SRTN only looks at preemption when processes arrive or come back from I/O
+static void check_preemption()
+{
+    if (scheduler_type == SRTN && running_process && !ready_queue_is_empty(des_heap_queue))
+    {
+        PCB* shortest = ready_queue_peek(des_heap_queue);
+        if (shortest->remaining_time < dispatched_remaining - units_ran)
+            preempt = 1;
+    }
+}
+
+static void handle_arrival(processParameters* params)
+{
+    if (!memory_fits(params->memsize))
+    {
+        LOG(LOG_PROC_GENERATOR, LOG_WARN, "[MAIN] Dropping process %d: %d bytes never fit in %d bytes of memory\n",
+            params->id, params->memsize, memory_size);
+        return;
+    }
+    BENCH_START(arrival_start);
+    PCB* process = (PCB*)malloc(sizeof(PCB));
+    if (!process)
+    {
+        perror("Failed to allocate memory for PCB");
+        exit(EXIT_FAILURE);
+    }
+    *process = (PCB){
+        .mtype = 1, .id = params->id, .pid = -1,
+        .arrival_time = params->arrival_time, .runtime = params->runtime,
+        .remaining_time = params->runtime, .priority = params->priority, .waiting_time = 0,
+        .start_time = -1, .last_run_time = -1, .finish_time = -1, .response_time = -1, .turnaround_time = -1,
+        .weighted_turnaround = -1,
+        .status = READY, .memsize = params->memsize, .mem_address = -1, .io_interval = params->io_interval,
+        .io_device = params->io_device, .burst_ran = 0, .channel = -1, .vm = NULL, // The account starts zeroed
+    };
+    // Processes that do not fit in memory yet wait outside the ready queue
+    if (memory_admit(process, params->arrival_time))
+        make_ready(process);
+    BENCH_STOP(BENCH_ENQUEUE, arrival_start);
+    process_count++;
+    check_preemption();
+}
+
+static void handle_io_done(int time)
+{
+    if (io_complete(time, make_ready))
+        check_preemption();
+}
+
+// Ends the CPU time of the running process
+static void release_cpu(int time)
+{
+    total_busy_time += time - slice_start;
+    io_cpu_busy(0, time);
+}
+
+static void finish_running(int time)
+{
+    running_process->finish_time = time;
+    running_process->remaining_time = 0;
+    log_process_state(running_process, "finished", time);
+    record_finished_process(running_process, time);
+    memory_release(running_process, time);
+    vm_release(running_process, time);
+    process_count--;
+    release_cpu(time);
+
+    free(running_process);
+    running_process = NULL;
+}
+
+static void stop_running(int time)
+{
+    running_process->last_run_time = time;
+    running_process->status = READY;
+    log_process_state(running_process, "stopped", time);
+    release_cpu(time);
+
+    make_ready(running_process);
+    running_process = NULL;
+}
+
+// The running process used up its CPU burst and waits for its device
+static void block_running(int time)
+{
+    release_cpu(time);
+    io_block(running_process, time);
+    running_process = NULL;
+}
+
+static void handle_slice_end(int time)
+{
+    if (scheduler_type == HPF)
+    {
+        // Faults of the slice keep the process on the CPU for their service time
+        slice_length = vm_run(running_process, slice_length);
+        if (slice_length > 0)
+            schedule_event(time + slice_length, EVENT_SLICE_END);
+        else if (io_burst_done(running_process))
+            block_running(time);
+        else
+            finish_running(time);
+    }
+    else if (scheduler_type == SRTN)
+    {
+        units_ran++;
+        running_process->burst_ran++;
+        if (dispatched_remaining > 0)
+            dispatched_remaining += vm_run(running_process, 1);
+        if (units_ran >= dispatched_remaining)
+        {
+            finish_running(time);
+            return;
+        }
+        running_process->remaining_time = dispatched_remaining - units_ran;
+        if (io_burst_done(running_process))
+            block_running(time);
+        else if (preempt)
+            stop_running(time);
+        else
+            schedule_event(time + 1, EVENT_SLICE_END);
+    }
+    else if (scheduler_type == RR)
+    {
+        int burst = cpu_burst_left(running_process);
+        int time_slice = (burst < quantum) ? burst : quantum;
+        running_process->remaining_time -= time_slice;
+        running_process->burst_ran += time_slice;
+        running_process->remaining_time += vm_run(running_process, time_slice);
+        if (running_process->remaining_time <= 0)
+            finish_running(time);
+        else if (io_burst_done(running_process))
+            block_running(time);
+        else
+            stop_running(time);
+    }
+}
+
+static void dispatch(int time)
+{
+    if (ready_queue_empty()) return;
+
+    slice_start = time;
+    if (scheduler_type == HPF)
+    {
+        running_process = hpf(des_heap_queue, time);
+        slice_length = cpu_burst_left(running_process);
+        running_process->remaining_time -= slice_length;
+        running_process->burst_ran += slice_length;
+        schedule_event(time + slice_length, EVENT_SLICE_END);
+    }
+    else if (scheduler_type == SRTN)
+    {
+        running_process = srtn(des_heap_queue, time);
+        dispatched_remaining = running_process->remaining_time;
+        units_ran = 0;
+        preempt = 0;
+        schedule_event(time + (dispatched_remaining > 0 ? 1 : 0), EVENT_SLICE_END);
+    }
+    else if (scheduler_type == RR)
+    {
+        running_process = rr(des_rr_queue, time);
+        int burst = cpu_burst_left(running_process);
+        int time_slice = (burst < quantum) ? burst : quantum;
+        schedule_event(time + time_slice, EVENT_SLICE_END);
+    }
+    io_cpu_busy(1, time);
+}
+
+void run_des_engine(workload_reader_t* workload)
+{
+    // Nothing else competes for the log, let stdio buffer it
+    flush_log_lines = 0;
+    if (open_scheduler_log() == -1)
+        exit(EXIT_FAILURE);
+    create_metrics_page(ENGINE_DES);
+
+    calendar = create_timing_wheel(0);
+    if (scheduler_type == HPF || scheduler_type == SRTN)
+        des_heap_queue = create_ready_queue(MAX_INPUT_PROCESSES);
+    else
+    {
+        des_rr_queue = (Deque*)malloc(sizeof(Deque));
+        initDeque(des_rr_queue, sizeof(PCB*));
+    }
+
+    des_workload = workload;
+    schedule_next_arrival(0);
+
+    int current_time = 0;
+    while (!timing_wheel_is_empty(calendar))
+    {
+        current_time = timing_wheel_next_expiry(calendar);
+
+        // Handle the tick's events in order, advancing again picks up the ones they add to this tick
+        while (1)
+        {
+            timing_wheel_advance(calendar, current_time, collect_event, NULL);
+            int type = take_pending_event();
+            if (type == -1)
+                break;
+
+            if (type == EVENT_ARRIVAL)
+            {
+                handle_arrival(&next_arrival);
+                schedule_next_arrival(current_time);
+            }
+            else if (type == EVENT_IO_DONE)
+                handle_io_done(current_time);
+            else
+                handle_slice_end(current_time);
+        }
+
+        // A request the devices started this tick needs its completion in the calendar
+        int io_done = io_next_completion();
+        if (io_done > current_time && io_done != io_event_time)
+        {
+            schedule_event(io_done, EVENT_IO_DONE);
+            io_event_time = io_done;
+        }
+
+        // Pick the next process once every event of this tick is in
+        memory_admit_waiting(current_time, make_ready);
+        if (running_process == NULL)
+            dispatch(current_time);
+        metrics_tick(current_time, ready_depth(), process_count, total_busy_time);
+    }
+
+    generate_statistics(current_time);
+    write_bench_report(current_time);
+
+    fclose(log_file);
+    log_file = NULL;
+    free_finished_processes();
+    cleanup_memory();
+    cleanup_vm();
+    cleanup_io();
+    destroy_metrics_page();
+    destroy_timing_wheel(calendar);
+    if (des_heap_queue)
+        destroy_ready_queue(des_heap_queue);
+    if (des_rr_queue)
+    {
+        clearDeque(des_rr_queue);
+        free(des_rr_queue);
+    }
+
+    LOG(LOG_SCHEDULER, LOG_INFO, "[SCHEDULER] Event-driven simulation finished at time %d\n", current_time);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "workload.h"
+
+// Simulation engines
+#define ENGINE_PROCESSES 0
+#define ENGINE_DES 1
+#define ENGINE_HOST 2 // Real commands, see host_engine.h
+
+void run_des_engine(workload_reader_t* workload);
@@ -0,0 +1,195 @@
+#include "disk_scheduler.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int disk_policy = DISK_NONE;
+
+static long long seek_distance = 0; // Cylinders
+static long long served = 0;
+static int* latencies = NULL;
+static long long latency_count = 0;
+static long long latency_capacity = 0;
+
+// splitmix64, same generator as os-sim-gen so cylinders do not depend on the platform
+static uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int parse_disk_policy(const char* name)
+{
+    if (strcmp(name, "fcfs") == 0) return DISK_FCFS;
+    if (strcmp(name, "sstf") == 0) return DISK_SSTF;
+    if (strcmp(name, "scan") == 0) return DISK_SCAN;
+    if (strcmp(name, "clook") == 0) return DISK_CLOOK;
+    return -1;
+}
+
+void init_disk(disk_t* disk)
+{
+    disk->pending = NULL;
+    disk->pending_count = 0;
+    disk->capacity = 0;
+    disk->head = 0;
+    disk->direction = 1;
+}
+
+int disk_request_cylinder(PCB* process)
+{
+    uint64_t state = (uint64_t)process->id * 0x9E3779B97F4A7C15ULL;
+    int home = (int)(splitmix64(&state) % DISK_CYLINDERS);
+    state ^= (uint64_t)(process->runtime - process->remaining_time) * 0xD1B54A32D192ED03ULL;
+    uint64_t random = splitmix64(&state);
+    if (!(random & 1))
+        return (int)((random >> 1) % DISK_CYLINDERS);
+
+    int cylinder = home + (int)((random >> 1) % (2 * DISK_LOCAL_SPAN + 1)) - DISK_LOCAL_SPAN;
+    if (cylinder < 0) return 0;
+    return cylinder < DISK_CYLINDERS ? cylinder : DISK_CYLINDERS - 1;
+}
+
+void disk_add(disk_t* disk, PCB* process, int cylinder)
+{
+    if (disk->pending_count == disk->capacity)
+    {
+        int capacity = disk->capacity ? disk->capacity * 2 : 16;
+        disk_request_t* grown = (disk_request_t*)realloc(disk->pending, sizeof(disk_request_t) * capacity);
+        if (!grown)
+        {
+            perror("Failed to grow disk queue");
+            exit(EXIT_FAILURE);
+        }
+        disk->pending = grown;
+        disk->capacity = capacity;
+    }
+    disk->pending[disk->pending_count++] = (disk_request_t){process, cylinder};
+}
+
+int disk_is_empty(disk_t* disk)
+{
+    return disk->pending_count == 0;
+}
+
+// Pending request closest to the head in the sweep direction, -1 when none is ahead
+static int nearest_ahead(disk_t* disk, int direction)
+{
+    int best = -1;
+    for (int i = 0; i < disk->pending_count; i++)
+    {
+        int distance = (disk->pending[i].cylinder - disk->head) * direction;
+        if (distance >= 0 && (best == -1 || distance < (disk->pending[best].cylinder - disk->head) * direction))
+            best = i;
+    }
+    return best;
+}
+
+// Index of the next request by the policy, sets the cylinders the head travels to reach it
+static int pick(disk_t* disk, int* distance)
+{
+    int best = 0;
+    if (disk_policy == DISK_SSTF)
+    {
+        for (int i = 1; i < disk->pending_count; i++)
+            if (abs(disk->pending[i].cylinder - disk->head) < abs(disk->pending[best].cylinder - disk->head))
+                best = i;
+    }
+    else if (disk_policy == DISK_SCAN)
+    {
+        best = nearest_ahead(disk, disk->direction);
+        if (best == -1)
+        {
+            // Run out to the last cylinder, turn and come back to the nearest request
+            int edge = disk->direction > 0 ? DISK_CYLINDERS - 1 : 0;
+            disk->direction = -disk->direction;
+            best = nearest_ahead(disk, disk->direction);
+            *distance = abs(edge - disk->head) + abs(edge - disk->pending[best].cylinder);
+            return best;
+        }
+    }
+    else if (disk_policy == DISK_CLOOK)
+    {
+        best = nearest_ahead(disk, 1);
+        if (best == -1)
+        {
+            // Jump back to the lowest request and sweep up again
+            best = 0;
+            for (int i = 1; i < disk->pending_count; i++)
+                if (disk->pending[i].cylinder < disk->pending[best].cylinder)
+                    best = i;
+        }
+    }
+    *distance = abs(disk->pending[best].cylinder - disk->head);
+    return best;
+}
+
+PCB* disk_next(disk_t* disk, int* seek_ticks)
+{
+    int distance;
+    int index = pick(disk, &distance);
+    disk_request_t request = disk->pending[index];
+    // Keep the rest in arrival order for FCFS and for ties
+    memmove(&disk->pending[index], &disk->pending[index + 1],
+            sizeof(disk_request_t) * (disk->pending_count - index - 1));
+    disk->pending_count--;
+
+    disk->head = request.cylinder;
+    seek_distance += distance;
+    served++;
+    *seek_ticks = (distance + DISK_CYLINDERS_PER_TICK - 1) / DISK_CYLINDERS_PER_TICK;
+    return request.process;
+}
+
+void disk_record_latency(int ticks)
+{
+    if (latency_count == latency_capacity)
+    {
+        long long capacity = latency_capacity ? latency_capacity * 2 : 1024;
+        int* grown = (int*)realloc(latencies, sizeof(int) * capacity);
+        if (!grown)
+        {
+            perror("Failed to grow disk latencies");
+            return;
+        }
+        latencies = grown;
+        latency_capacity = capacity;
+    }
+    latencies[latency_count++] = ticks;
+}
+
+static int compare_ints(const void* a, const void* b)
+{
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of the sorted latencies
+static int percentile(double p)
+{
+    long long rank = (long long)(p / 100.0 * latency_count + 0.999999);
+    if (rank < 1) rank = 1;
+    return latencies[rank - 1];
+}
+
+void write_disk_stats(FILE* perf_file)
+{
+    if (disk_policy == DISK_NONE || served == 0)
+        return;
+    fprintf(perf_file, "Disk seek distance = %lld\n", seek_distance);
+    fprintf(perf_file, "Avg disk seek = %.2f\n", (double)seek_distance / served);
+    if (latency_count == 0)
+        return;
+    qsort(latencies, latency_count, sizeof(int), compare_ints);
+    fprintf(perf_file, "Disk latency p50 = %d\n", percentile(50));
+    fprintf(perf_file, "Disk latency p95 = %d\n", percentile(95));
+    fprintf(perf_file, "Disk latency p99 = %d\n", percentile(99));
+}
+
+void destroy_disk(disk_t* disk)
+{
+    free(disk->pending);
+    init_disk(disk);
+}
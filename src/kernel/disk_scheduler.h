@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdio.h>
+#include "pcb.h"
+
+// Seek scheduling policies of the disk (--disk)
+#define DISK_NONE 0
+#define DISK_FCFS 1
+#define DISK_SSTF 2
+#define DISK_SCAN 3
+#define DISK_CLOOK 4
+
+#define DISK_CYLINDERS 200
+#define DISK_CYLINDERS_PER_TICK 50 // Seek speed, a full stroke takes 4 ticks
+#define DISK_LOCAL_SPAN 10 // Half the requests land within this many cylinders of the process's home cylinder
+
+/*
+ * Seek scheduling of the simulated disk, I/O device 0 when --disk is given.
+ * Every request carries a cylinder, drawn per process and request from a
+ * seeded stream around a home cylinder of the process, and the disk picks
+ * the next pending request by its policy: arrival order (FCFS), nearest to
+ * the head (SSTF), the elevator sweeping to the last cylinder before turning
+ * (SCAN) or upward sweeps that jump back to the lowest request (C-LOOK).
+ * A request takes the device's service time plus its seek time.
+ */
+typedef struct
+{
+    PCB* process;
+    int cylinder;
+} disk_request_t;
+
+typedef struct
+{
+    disk_request_t* pending; // Arrival order
+    int pending_count;
+    int capacity;
+    int head; // Cylinder under the head
+    int direction; // 1 sweeping up, -1 down (SCAN)
+} disk_t;
+
+extern int disk_policy;
+
+// DISK_FCFS..DISK_CLOOK for fcfs, sstf, scan or clook, -1 for anything else
+int parse_disk_policy(const char* name);
+void init_disk(disk_t* disk);
+// Cylinder of the process's next request, the same for the same process and progress on every run
+int disk_request_cylinder(PCB* process);
+void disk_add(disk_t* disk, PCB* process, int cylinder);
+int disk_is_empty(disk_t* disk);
+// Takes the next request by the policy and moves the head to it, returns the process and sets the seek ticks
+PCB* disk_next(disk_t* disk, int* seek_ticks);
+// Time from a request being made to its completion, for the percentiles
+void disk_record_latency(int ticks);
+// Appends the seek and latency statistics to the performance file, nothing when the disk served nothing
+void write_disk_stats(FILE* perf_file);
+void destroy_disk(disk_t* disk);
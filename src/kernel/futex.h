@@ -0,0 +1,61 @@
+#pragma once
+
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*
+ * Futex waits on words in System V shared memory, so a process can sleep
+ * until another one changes a word instead of polling it. The operations
+ * are the shared (not process-private) ones since the word is mapped by
+ * several processes.
+ */
+
+// Sleeps while *word still holds `expected`, until woken, a signal or the timeout (NULL for none)
+static inline void futex_wait(int* word, int expected, const struct timespec* timeout)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+// Wakes every process sleeping on the word
+static inline void futex_wake_all(int* word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+#define FUTEX_WAIT_ANY_MAX 4
+
+/*
+ * Sleeps while every words[i] still holds expected[i], until one of them is
+ * woken, a signal or `timeout_ns` (0 for none) passes. Kernels without
+ * futex_waitv (before 5.16) get a bounded sleep on the first word instead.
+ */
+static inline void futex_wait_any(int* const words[], const int expected[], int count, long timeout_ns)
+{
+    struct futex_waitv waiters[FUTEX_WAIT_ANY_MAX] = {0};
+    for (int i = 0; i < count && i < FUTEX_WAIT_ANY_MAX; i++)
+    {
+        waiters[i].val = (unsigned int)expected[i];
+        waiters[i].uaddr = (unsigned long)words[i];
+        waiters[i].flags = FUTEX_32;
+    }
+
+    // futex_waitv takes an absolute deadline
+    struct timespec deadline;
+    if (timeout_ns)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += timeout_ns;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+    }
+    if (syscall(SYS_futex_waitv, waiters, count < FUTEX_WAIT_ANY_MAX ? count : FUTEX_WAIT_ANY_MAX, 0,
+                timeout_ns ? &deadline : NULL, CLOCK_MONOTONIC) != -1 || errno != ENOSYS)
+        return;
+
+    struct timespec fallback = {0, timeout_ns && timeout_ns < 1000000L ? timeout_ns : 1000000L};
+    futex_wait(words[0], expected[0], &fallback);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "accounting.h"
+
 // Message structure for IPC
 typedef struct
 {
@@ -9,6 +11,9 @@ typedef struct
     int arrival_time;
     int runtime;
     int priority;
+    int memsize; // Bytes of simulated memory, 0 when the process needs none
+    int io_interval; // CPU ticks between I/O requests, 0 for a CPU-bound process
+    int io_device; // Device its I/O requests go to
 } processParameters;
 
 typedef struct
@@ -16,6 +21,10 @@ typedef struct
     int ta; // process->finish_time - process->arrival_time;
     float wta; // (float)ta / process->runtime;
     int waiting_time;
+    int id;
+    int arrival_time;
+    int response_time; // First dispatch less the arrival
+    process_account_t account;
 } finishedProcessInfo;
 
 #define MAX_INPUT_PROCESSES 100
@@ -26,9 +35,9 @@ typedef struct
 #define RUNNING 1
 #define TERMINATED 2 // I Think using this is wrong
 
-// Extra States (IDK if we'll use them)
-#define BLOCKED 2
+// Extra States
 #define PAUSED 3
+#define BLOCKED 4 // Waiting for or using an I/O device
 
 // Scheduling algorithms
 #define RR 0
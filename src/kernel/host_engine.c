@@ -0,0 +1,427 @@
+#include "host_engine.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "colors.h"
+#include "logging.h"
+#include "des_engine.h"
+#include "headers.h"
+#include "metrics_page.h"
+#include "pcb.h"
+#include "deque.h"
+#include "ready_queue.h"
+#include "scheduler.h"
+#include "scheduler_utils.h"
+
+#define DEFAULT_HOST_TICK_US 1000000 // Same default tick as the clock
+#define MAX_COMMAND 1024
+
+extern int scheduler_type;
+extern int quantum;
+extern int total_busy_time;
+
+typedef struct
+{
+    int id;
+    int arrival_time;
+    int runtime; // Estimate in ticks
+    int priority;
+    char command[MAX_COMMAND];
+    pid_t pid; // Process group running it, -1 until it arrives
+    int finished;
+} command_job_t;
+
+static command_job_t* jobs = NULL;
+static int job_count = 0;
+
+static ready_queue_t* host_heap_queue = NULL;
+static Deque* host_rr_queue = NULL; // PCB pointers
+
+static long long tick_ns;
+static long long start_ns;
+static int dispatch_time = 0; // Tick the running job got the CPU
+
+static int host_engine_used = 0;
+static long long job_cpu_ns = 0; // Measured CPU time of the finished jobs
+
+static long long monotonic_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static int elapsed_ticks()
+{
+    return (int)((monotonic_ns() - start_ns) / tick_ns);
+}
+
+static int compare_jobs(const void* a, const void* b)
+{
+    const command_job_t* x = (const command_job_t*)a;
+    const command_job_t* y = (const command_job_t*)b;
+    if (x->arrival_time != y->arrival_time)
+        return x->arrival_time - y->arrival_time;
+    return x->id - y->id;
+}
+
+// Reads every job of the file, sorted by arrival, returns -1 when the file cannot be read
+static int load_jobs(const char* job_file)
+{
+    FILE* file = fopen(job_file, "r");
+    if (!file)
+        return -1;
+
+    int capacity = 0;
+    char line[MAX_COMMAND + 64];
+    while (fgets(line, sizeof(line), file))
+    {
+        int offset = 0;
+        command_job_t job;
+        if (line[0] == '#' || sscanf(line, "%d %d %d %d %n", &job.id, &job.arrival_time, &job.runtime,
+                                     &job.priority, &offset) != 4 || line[offset] == '\0' || line[offset] == '\n')
+            continue;
+        line[strcspn(line, "\r\n")] = '\0';
+        snprintf(job.command, sizeof(job.command), "%s", line + offset);
+        job.pid = -1;
+        job.finished = 0;
+        if (job.runtime < 1)
+            job.runtime = 1;
+
+        if (job_count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            command_job_t* grown = (command_job_t*)realloc(jobs, sizeof(command_job_t) * capacity);
+            if (!grown)
+            {
+                perror("Failed to grow the job list");
+                exit(EXIT_FAILURE);
+            }
+            jobs = grown;
+        }
+        jobs[job_count++] = job;
+    }
+    fclose(file);
+    qsort(jobs, job_count, sizeof(command_job_t), compare_jobs);
+    return 0;
+}
+
+static command_job_t* find_job(pid_t pid)
+{
+    for (int i = 0; i < job_count; i++)
+        if (jobs[i].pid == pid)
+            return &jobs[i];
+    return NULL;
+}
+
+/*
+ * CPU time the job used so far, -1 once its leader is gone.
+ * Only the group leader's /proc stat is read, one file per tick instead of a
+ * scan of every process: its own time plus the time of the children it
+ * reaped. The shell execs a simple command in place, and a pipeline's stages
+ * count once the shell reaps them, so a child still running is only charged
+ * at its exit, where the rusage replaces the estimate anyway.
+ */
+static long long job_cpu_time(pid_t leader)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)leader);
+    FILE* stat = fopen(path, "r");
+    if (!stat)
+        return -1;
+    char line[1024];
+    // The command name may hold spaces and parentheses, the numeric fields start after the last ')'
+    char* fields = fgets(line, sizeof(line), stat) ? strrchr(line, ')') : NULL;
+    fclose(stat);
+    unsigned long utime, stime;
+    long cutime, cstime;
+    if (!fields || sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %ld %ld", &utime,
+                          &stime, &cutime, &cstime) != 4)
+        return -1;
+    long long ticks = (long long)utime + (long long)stime + cutime + cstime;
+    return ticks * 1000000000LL / sysconf(_SC_CLK_TCK);
+}
+
+// The estimate less the CPU ticks used, at least one while the job is alive
+static void update_remaining(PCB* process)
+{
+    long long used = job_cpu_time(process->pid);
+    if (used < 0)
+        return;
+    int remaining = process->runtime - (int)(used / tick_ns);
+    process->remaining_time = remaining > 0 ? remaining : 1;
+}
+
+/*
+ * Starts the job's command in its own process group, stopped before the
+ * exec so it only runs once dispatched.
+ */
+static pid_t launch(command_job_t* job)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        setpgid(0, 0);
+        raise(SIGSTOP);
+        execl("/bin/sh", "sh", "-c", job->command, (char*)NULL);
+        perror("execl failed");
+        _exit(127);
+    }
+    else if (pid < 0)
+    {
+        perror("fork failed");
+        return -1;
+    }
+    setpgid(pid, pid);
+    int status;
+    waitpid(pid, &status, WUNTRACED);
+    return pid;
+}
+
+static void make_ready(PCB* process)
+{
+    if (scheduler_type == RR)
+        pushBack(host_rr_queue, &process);
+    else
+        ready_queue_insert(host_heap_queue, process);
+}
+
+static int ready_queue_empty()
+{
+    if (scheduler_type == RR)
+        return isDequeEmpty(host_rr_queue);
+    return ready_queue_is_empty(host_heap_queue);
+}
+
+static int ready_depth()
+{
+    if (scheduler_type == RR)
+        return (int)host_rr_queue->size;
+    return ready_queue_size(host_heap_queue);
+}
+
+static void handle_arrival(command_job_t* job, int time)
+{
+    job->pid = launch(job);
+    if (job->pid == -1)
+    {
+        job->finished = 1;
+        return;
+    }
+
+    PCB* process = (PCB*)malloc(sizeof(PCB));
+    if (!process)
+    {
+        perror("Failed to allocate memory for PCB");
+        exit(EXIT_FAILURE);
+    }
+    *process = (PCB){
+        .mtype = 1, .id = job->id, .pid = job->pid,
+        .arrival_time = job->arrival_time, .runtime = job->runtime,
+        .remaining_time = job->runtime, .priority = job->priority, .waiting_time = 0,
+        .start_time = -1, .last_run_time = -1, .finish_time = -1, .response_time = -1, .turnaround_time = -1,
+        .weighted_turnaround = -1,
+        .status = READY, .memsize = 0, .mem_address = -1, .io_interval = 0,
+        .io_device = 0, .burst_ran = 0, .channel = -1, .vm = NULL, // The account starts zeroed
+    };
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Started job %d as pid %d at %d: %s\n", job->id, job->pid, time,
+        job->command);
+    make_ready(process);
+    process_count++;
+}
+
+static void finish_running(int time, long long cpu_ns)
+{
+    command_job_t* job = find_job(running_process->pid);
+    if (job)
+        job->finished = 1;
+
+    // WTA is against the CPU time the job really used
+    int cpu_ticks = (int)((cpu_ns + tick_ns - 1) / tick_ns);
+    running_process->runtime = cpu_ticks > 0 ? cpu_ticks : 1;
+    running_process->finish_time = time;
+    running_process->remaining_time = 0;
+    log_process_state(running_process, "finished", time);
+    record_finished_process(running_process, time);
+    process_count--;
+    total_busy_time += time - dispatch_time;
+    job_cpu_ns += cpu_ns;
+
+    free(running_process);
+    running_process = NULL;
+}
+
+static void stop_running(int time)
+{
+    kill(-running_process->pid, SIGSTOP);
+    update_remaining(running_process);
+    running_process->last_run_time = time;
+    running_process->status = READY;
+    log_process_state(running_process, "stopped", time);
+    total_busy_time += time - dispatch_time;
+
+    make_ready(running_process);
+    running_process = NULL;
+}
+
+// Takes in every job that exited, only the running one can
+static void reap_jobs(int time)
+{
+    int status;
+    struct rusage usage;
+    pid_t pid;
+    while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0)
+    {
+        if (!WIFEXITED(status) && !WIFSIGNALED(status))
+            continue;
+        long long cpu_ns = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL +
+            (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+        if (running_process && running_process->pid == pid)
+            finish_running(time, cpu_ns);
+        else
+        {
+            // Killed from outside while waiting, dispatch() drops it
+            command_job_t* job = find_job(pid);
+            if (job)
+                job->finished = 1;
+            job_cpu_ns += cpu_ns;
+        }
+    }
+}
+
+// RR stops the job at the end of its quantum, SRTN when a ready job has less time left
+static void check_running(int time)
+{
+    if (scheduler_type == RR && time - dispatch_time >= quantum)
+        stop_running(time);
+    else if (scheduler_type == SRTN && !ready_queue_is_empty(host_heap_queue))
+    {
+        update_remaining(running_process);
+        if (ready_queue_peek(host_heap_queue)->remaining_time < running_process->remaining_time)
+            stop_running(time);
+    }
+}
+
+static void dispatch(int time)
+{
+    while (running_process == NULL && !ready_queue_empty())
+    {
+        if (scheduler_type == HPF)
+            running_process = hpf(host_heap_queue, time);
+        else if (scheduler_type == SRTN)
+            running_process = srtn(host_heap_queue, time);
+        else
+            running_process = rr(host_rr_queue, time);
+        dispatch_time = time;
+
+        command_job_t* job = find_job(running_process->pid);
+        if ((job && job->finished) || kill(-running_process->pid, SIGCONT) == -1)
+            finish_running(time, 0);
+    }
+}
+
+// Sleeps until the next tick boundary or until a job exits
+static void wait_for_tick(sigset_t* sigchld, int next_tick)
+{
+    long long left = start_ns + next_tick * tick_ns - monotonic_ns();
+    if (left <= 0)
+        return;
+    struct timespec timeout = {left / 1000000000LL, left % 1000000000LL};
+    sigtimedwait(sigchld, NULL, &timeout);
+}
+
+// Interrupted runs take their jobs down with them, only async-signal-safe calls here
+static void host_engine_cleanup(__attribute__((unused)) int signum)
+{
+    for (int i = 0; i < job_count; i++)
+        if (jobs[i].pid > 0 && !jobs[i].finished)
+            kill(-jobs[i].pid, SIGKILL);
+    // The metrics page stays behind, os-sim-top sees the scheduler is gone
+    _exit(1);
+}
+
+void run_host_engine(const char* job_file)
+{
+    if (load_jobs(job_file) == -1)
+    {
+        perror(ANSI_COLOR_GREEN"[SCHEDULER] Error opening the job list"ANSI_COLOR_RESET);
+        exit(EXIT_FAILURE);
+    }
+    if (open_scheduler_log() == -1)
+        exit(EXIT_FAILURE);
+    host_engine_used = 1;
+    create_metrics_page(ENGINE_HOST);
+
+    const char* tick_env = getenv("OS_SIM_TICK_US");
+    long long tick_us = tick_env ? atoll(tick_env) : 0;
+    tick_ns = (tick_us > 0 ? tick_us : DEFAULT_HOST_TICK_US) * 1000LL;
+
+    if (scheduler_type == HPF || scheduler_type == SRTN)
+        host_heap_queue = create_ready_queue(MAX_INPUT_PROCESSES);
+    else
+    {
+        host_rr_queue = (Deque*)malloc(sizeof(Deque));
+        initDeque(host_rr_queue, sizeof(PCB*));
+    }
+
+    // Exits are taken with sigtimedwait(), SIGCHLD stays pending until then
+    sigset_t sigchld;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, NULL);
+    signal(SIGINT, host_engine_cleanup);
+
+    start_ns = monotonic_ns();
+    int next_job = 0;
+    int current_time = 0;
+    while (next_job < job_count || process_count > 0)
+    {
+        current_time = elapsed_ticks();
+        reap_jobs(current_time);
+        while (next_job < job_count && jobs[next_job].arrival_time <= current_time)
+            handle_arrival(&jobs[next_job++], current_time);
+
+        if (running_process)
+            check_running(current_time);
+        if (running_process == NULL)
+            dispatch(current_time);
+        metrics_tick(current_time, ready_depth(), process_count, total_busy_time);
+
+        wait_for_tick(&sigchld, current_time + 1);
+    }
+
+    generate_statistics(current_time);
+
+    fclose(log_file);
+    log_file = NULL;
+    free_finished_processes();
+    destroy_metrics_page();
+    if (host_heap_queue)
+        destroy_ready_queue(host_heap_queue);
+    if (host_rr_queue)
+    {
+        clearDeque(host_rr_queue);
+        free(host_rr_queue);
+    }
+    free(jobs);
+
+    LOG(LOG_SCHEDULER, LOG_INFO, "[SCHEDULER] Host jobs finished at time %d\n", current_time);
+}
+
+void write_host_stats(FILE* perf_file)
+{
+    if (!host_engine_used)
+        return;
+    double cpu_seconds = job_cpu_ns / 1e9;
+    double held_seconds = (double)total_busy_time * tick_ns / 1e9;
+    fprintf(perf_file, "Job CPU time = %.2fs\n", cpu_seconds);
+    // Share of the time the jobs held the CPU that they spent computing rather than blocked
+    fprintf(perf_file, "CPU efficiency = %.2f%%\n", held_seconds > 0 ? 100.0 * cpu_seconds / held_seconds : 0.0);
+}
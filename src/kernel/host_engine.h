@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdio.h>
+
+/*
+ * Host engine: schedules real commands instead of simulated jobs.
+ * The job file lists `id arrival runtime priority command...`, the runtime
+ * being an estimate in ticks that SRTN orders by. Each command runs under
+ * /bin/sh in its own process group, which stays stopped (SIGSTOP) except
+ * while the policy gives it the CPU (SIGCONT). Ticks are wall-clock ticks of
+ * OS_SIM_TICK_US, and the CPU time a job really used, read from its CPU-time
+ * clock while it runs and from its rusage once it exits, replaces the
+ * estimate, so WTA is against the measured runtime.
+ */
+void run_host_engine(const char* job_file);
+// Appends the measured CPU time of the jobs to the performance file, nothing outside the host engine
+void write_host_stats(FILE* perf_file);
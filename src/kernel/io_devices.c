@@ -0,0 +1,228 @@
+#include "io_devices.h"
+#include <stdlib.h>
+#include <string.h>
+#include "deque.h"
+#include "headers.h"
+#include "colors.h"
+#include "logging.h"
+#include "scheduler_utils.h"
+#include "disk_scheduler.h"
+
+int io_device_count = 1;
+int io_service_ticks[MAX_IO_DEVICES] = {DEFAULT_IO_SERVICE_TICKS};
+
+typedef struct
+{
+    Deque queue; // PCB pointers waiting for the device, FCFS
+    PCB* serving; // NULL while idle
+    int done; // Tick the request in service ends
+    long long busy_ticks;
+} io_device_t;
+
+static io_device_t* devices = NULL;
+static int busy_devices = 0;
+static disk_t disk; // Queue of device 0 instead of its deque when a seek policy is set
+
+// CPU+I/O overlap, integrated over time from the first request
+static int cpu_busy = 0;
+static int stats_time = 0;
+static long long overlap_ticks = 0;
+
+static long long io_requests = 0;
+static long long total_queue_wait = 0; // Ticks requests waited before their device took them
+
+int parse_io_devices(char* list)
+{
+    int count = 0;
+    for (char* item = strtok(list, ","); item; item = strtok(NULL, ","))
+    {
+        int ticks = atoi(item);
+        if (ticks <= 0 || count == MAX_IO_DEVICES)
+            return -1;
+        io_service_ticks[count++] = ticks;
+    }
+    if (count == 0)
+        return -1;
+    io_device_count = count;
+    return 0;
+}
+
+int cpu_burst_left(PCB* process)
+{
+    if (process->io_interval <= 0)
+        return process->remaining_time;
+    int left = process->io_interval - process->burst_ran;
+    return left < process->remaining_time ? left : process->remaining_time;
+}
+
+int io_burst_done(PCB* process)
+{
+    return process->io_interval > 0 && process->burst_ran >= process->io_interval && process->remaining_time > 0;
+}
+
+static void account(int time)
+{
+    if (time <= stats_time)
+        return;
+    if (cpu_busy && busy_devices)
+        overlap_ticks += time - stats_time;
+    stats_time = time;
+}
+
+static void init_io(int time)
+{
+    devices = (io_device_t*)calloc(io_device_count, sizeof(io_device_t));
+    if (!devices)
+    {
+        perror("Failed to allocate I/O devices");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < io_device_count; i++)
+        initDeque(&devices[i].queue, sizeof(PCB*));
+    init_disk(&disk);
+    stats_time = time;
+}
+
+static int is_disk(io_device_t* device)
+{
+    return disk_policy != DISK_NONE && device == devices;
+}
+
+static void start_request(io_device_t* device, PCB* process, int time, int seek_ticks)
+{
+    account(time);
+    if (!device->serving)
+        busy_devices++;
+    int service = io_service_ticks[device - devices] + seek_ticks;
+    device->serving = process;
+    device->done = time + service;
+    device->busy_ticks += service;
+    total_queue_wait += time - process->last_run_time;
+}
+
+// Starts the device's next queued request, returns 0 when nothing is queued
+static int start_next(io_device_t* device, int time)
+{
+    PCB* next;
+    if (is_disk(device))
+    {
+        if (disk_is_empty(&disk))
+            return 0;
+        int seek_ticks;
+        next = disk_next(&disk, &seek_ticks);
+        start_request(device, next, time, seek_ticks);
+        return 1;
+    }
+    if (!popFront(&device->queue, &next))
+        return 0;
+    start_request(device, next, time, 0);
+    return 1;
+}
+
+void io_block(PCB* process, int time)
+{
+    if (!devices)
+        init_io(time);
+
+    process->status = BLOCKED;
+    process->last_run_time = time;
+    process->burst_ran = 0;
+    io_requests++;
+    log_process_state(process, "blocked", time);
+
+    io_device_t* device = &devices[process->io_device % io_device_count];
+    if (is_disk(device))
+    {
+        // Queued even when idle so the head seeks to the cylinder
+        disk_add(&disk, process, disk_request_cylinder(process));
+        if (!device->serving)
+            start_next(device, time);
+    }
+    else if (device->serving)
+        pushBack(&device->queue, &process);
+    else
+        start_request(device, process, time, 0);
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[IO] Process %d blocked on device %d\n", process->id, (int)(device - devices));
+}
+
+int io_complete(int time, void (*make_ready)(PCB*))
+{
+    if (!devices)
+        return 0;
+
+    int completed = 0;
+    for (int i = 0; i < io_device_count; i++)
+    {
+        io_device_t* device = &devices[i];
+        while (device->serving && device->done <= time)
+        {
+            account(device->done);
+            PCB* process = device->serving;
+            if (is_disk(device))
+                disk_record_latency(device->done - process->last_run_time);
+            // Time on the device is not time spent waiting for the CPU
+            process->status = READY;
+            process->last_run_time = device->done;
+            account_enter(&process->account, process->arrival_time, ACCOUNT_READY, device->done);
+            make_ready(process);
+            completed++;
+
+            if (!start_next(device, device->done))
+            {
+                device->serving = NULL;
+                busy_devices--;
+            }
+        }
+    }
+    return completed;
+}
+
+int io_next_completion()
+{
+    int next = -1;
+    for (int i = 0; devices && i < io_device_count; i++)
+        if (devices[i].serving && (next == -1 || devices[i].done < next))
+            next = devices[i].done;
+    return next;
+}
+
+void io_cpu_busy(int busy, int time)
+{
+    if (devices)
+        account(time);
+    cpu_busy = busy;
+}
+
+void write_io_stats(FILE* perf_file, int time)
+{
+    if (!devices)
+        return;
+    account(time);
+    // Over the whole run like the CPU utilization
+    int span = time > 0 ? time : 1;
+    fprintf(perf_file, "I/O requests = %lld\n", io_requests);
+    fprintf(perf_file, "Avg I/O queue wait = %.2f\n", io_requests ? (double)total_queue_wait / io_requests : 0.0);
+    for (int i = 0; i < io_device_count; i++)
+        fprintf(perf_file, "Device %d utilization = %.2f%%\n", i, 100.0 * devices[i].busy_ticks / span);
+    fprintf(perf_file, "CPU and I/O overlap = %.2f%%\n", 100.0 * overlap_ticks / span);
+    write_disk_stats(perf_file);
+}
+
+void cleanup_io()
+{
+    if (!devices)
+        return;
+    for (int i = 0; i < io_device_count; i++)
+    {
+        PCB* process;
+        while (popFront(&devices[i].queue, &process))
+            free(process);
+        clearDeque(&devices[i].queue);
+        free(devices[i].serving);
+    }
+    for (int i = 0; i < disk.pending_count; i++)
+        free(disk.pending[i].process);
+    destroy_disk(&disk);
+    free(devices);
+    devices = NULL;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdio.h>
+#include "pcb.h"
+
+#define MAX_IO_DEVICES 16
+#define DEFAULT_IO_SERVICE_TICKS 2
+
+/*
+ * Simulated I/O devices.
+ * A process with an I/O interval runs that many CPU ticks, then blocks on an
+ * I/O request to its device (taken modulo the device count) until the
+ * device has served it, and so on until its runtime is used up; a process
+ * does no I/O after its last burst. Each device serves its FCFS queue one
+ * request at a time, each request taking the device's service time (device 0
+ * orders its queue by seek policy instead with --disk, see disk_scheduler.h). The
+ * devices are set up with the first request, CPU-bound workloads never touch
+ * them. Device utilization and the share of time the CPU and a device were
+ * busy together go to scheduler.perf.
+ */
+extern int io_device_count;
+extern int io_service_ticks[MAX_IO_DEVICES];
+
+// Parses comma-separated service times, one device each (--devices), returns -1 when one is not positive
+int parse_io_devices(char* list);
+// CPU ticks the process runs before its next I/O request, its remaining time when it does no more I/O
+int cpu_burst_left(PCB* process);
+// Whether the process just used up a CPU burst and has time left, so it blocks instead of going back to ready
+int io_burst_done(PCB* process);
+// Blocks the process on its device, starting the request at once when the device is idle
+void io_block(PCB* process, int time);
+// Finishes every request served by `time` and hands the processes to make_ready, returns how many there were
+int io_complete(int time, void (*make_ready)(PCB*));
+// Tick the earliest request in service ends, -1 when every device is idle
+int io_next_completion();
+// The engines report when the CPU starts and stops running a process, for the CPU+I/O overlap
+void io_cpu_busy(int busy, int time);
+// Appends the device statistics to the performance file, nothing when no process did I/O
+void write_io_stats(FILE* perf_file, int time);
+void cleanup_io();
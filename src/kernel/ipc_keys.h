@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+// Message queue between the generator and the scheduler
+#define MSG_QUEUE_KEY 700
+
+// Keys of one namespace are this far apart from the next one
+#define IPC_NAMESPACE_STRIDE 1000
+
+/*
+ * Returns the System V key for `base` inside the namespace given by the
+ * OS_SIM_IPC_NS environment variable (0 when unset), so several simulations
+ * can run side by side without sharing queues or shared memory.
+ * Children inherit the variable, so every component agrees on the keys.
+ */
+static inline key_t ipc_key(int base)
+{
+    static int ipc_namespace = -1;
+    if (ipc_namespace == -1)
+    {
+        const char* value = getenv("OS_SIM_IPC_NS");
+        ipc_namespace = value ? atoi(value) : 0;
+        if (ipc_namespace < 0)
+            ipc_namespace = 0;
+    }
+    return (key_t)(base + ipc_namespace * IPC_NAMESPACE_STRIDE);
+}
@@ -0,0 +1,100 @@
+#ifdef OS_SIM_LATENCY
+
+#include "latency.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICK_US 1000000 // Same default tick as the clock
+
+typedef struct
+{
+    long long count;
+    long long total_ns;
+    long long max_ns;
+    long long over_tick; // Samples longer than one clock tick
+    long long buckets[LATENCY_BUCKETS];
+} latency_hop_t;
+
+static latency_hop_t latency_hops[LATENCY_HOPS];
+
+static const char* const latency_hop_names[LATENCY_HOPS] = {"queue", "dispatch", "completion", "exit"};
+static long long tick_ns = 0;
+
+static long long latency_tick_ns()
+{
+    if (tick_ns == 0)
+    {
+        const char* tick_env = getenv("OS_SIM_TICK_US");
+        long long tick_us = tick_env ? atoll(tick_env) : 0;
+        tick_ns = (tick_us > 0 ? tick_us : DEFAULT_TICK_US) * 1000LL;
+    }
+    return tick_ns;
+}
+
+void latency_record(int hop, long long start_ns, long long end_ns)
+{
+    if (start_ns <= 0)
+        return;
+    long long elapsed_ns = end_ns - start_ns;
+    if (elapsed_ns < 0)
+        elapsed_ns = 0;
+
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && elapsed_ns >= (1LL << bucket))
+        bucket++;
+
+    latency_hop_t* h = &latency_hops[hop];
+    h->buckets[bucket]++;
+    h->count++;
+    h->total_ns += elapsed_ns;
+    if (elapsed_ns > h->max_ns)
+        h->max_ns = elapsed_ns;
+    if (elapsed_ns > latency_tick_ns())
+        h->over_tick++;
+}
+
+// Upper edge of the bucket holding the given share of the samples (at most the max), nearest rank
+static long long latency_percentile(const latency_hop_t* h, double share)
+{
+    long long rank = (long long)(share * h->count + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    long long seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS - 1; b++)
+    {
+        seen += h->buckets[b];
+        if (seen >= rank)
+            return (1LL << b) < h->max_ns ? 1LL << b : h->max_ns;
+    }
+    return h->max_ns;
+}
+
+void write_latency_report()
+{
+    FILE* latency_file = fopen("scheduler.latency", "w");
+    if (!latency_file)
+    {
+        perror("Failed to open latency file");
+        return;
+    }
+
+    fprintf(latency_file, "#hop\tsamples\tmean_ns\tp50_ns\tp95_ns\tp99_ns\tmax_ns\tover_tick\n");
+    for (int i = 0; i < LATENCY_HOPS; i++)
+    {
+        latency_hop_t* h = &latency_hops[i];
+        fprintf(latency_file, "%s\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\n", latency_hop_names[i], h->count,
+                h->count ? h->total_ns / h->count : 0, h->count ? latency_percentile(h, 0.50) : 0,
+                h->count ? latency_percentile(h, 0.95) : 0, h->count ? latency_percentile(h, 0.99) : 0, h->max_ns,
+                h->over_tick);
+    }
+
+    fprintf(latency_file, "#hop\tbelow_ns\tsamples\n");
+    for (int i = 0; i < LATENCY_HOPS; i++)
+        for (int b = 0; b < LATENCY_BUCKETS; b++)
+            if (latency_hops[i].buckets[b])
+                fprintf(latency_file, "%s\t%lld\t%lld\n", latency_hop_names[i],
+                        b < LATENCY_BUCKETS - 1 ? 1LL << b : -1LL, latency_hops[i].buckets[b]);
+    fclose(latency_file);
+}
+
+#endif
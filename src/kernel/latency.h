@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * End-to-end latency probes of the multi-process engine's IPC pipeline
+ * (make latency, -DOS_SIM_LATENCY). The scheduler and its processes must be
+ * built with the same setting, the probes add timestamps to the PCB and the
+ * command channels. In normal builds every macro compiles to nothing.
+ */
+#ifdef OS_SIM_LATENCY
+
+#include <time.h>
+
+// Hops, each measured from the CLOCK_MONOTONIC timestamp of one point to the next
+#define LATENCY_QUEUE 0 // Generator msgsnd() to the intake thread's msgrcv()
+#define LATENCY_DISPATCH 1 // Scheduler rings RUN to the process observing the command
+#define LATENCY_COMPLETION 2 // Process acknowledges its slice to the scheduler seeing the acknowledgement
+#define LATENCY_EXIT 3 // Process acknowledges its last slice to the scheduler finishing it
+#define LATENCY_HOPS 4
+
+// Bucket b holds latencies below 2^b ns, the last one everything above
+#define LATENCY_BUCKETS 40
+
+static inline long long latency_now_ns()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Adds one sample to the hop, ignored when the start was never stamped
+void latency_record(int hop, long long start_ns, long long end_ns);
+
+/*
+ * Writes scheduler.latency: per hop the sample count, mean, p50/p95/p99
+ * (upper edge of the bucket), max and the samples longer than one tick,
+ * then every hop's non-empty histogram buckets.
+ */
+void write_latency_report();
+
+#define LATENCY_STAMP(field) ((field) = latency_now_ns())
+#define LATENCY_RECORD(hop, start_ns) latency_record(hop, start_ns, latency_now_ns())
+
+#else
+
+#define LATENCY_STAMP(field)
+#define LATENCY_RECORD(hop, start_ns)
+#define write_latency_report()
+
+#endif
@@ -0,0 +1,75 @@
+#include "logging.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "colors.h"
+
+int log_levels[LOG_MODULES] = {-1, -1, -1, -1, -1};
+
+static const char* const log_module_names[LOG_MODULES] = {
+    "clock", "scheduler", "proc_generator", "process", "shared_mem"
+};
+static const char* const log_module_colors[LOG_MODULES] = {
+    ANSI_COLOR_CYAN, ANSI_COLOR_GREEN, ANSI_COLOR_BLUE, ANSI_COLOR_YELLOW, ANSI_COLOR_TEAL
+};
+static const char* const log_level_names[] = {"error", "warn", "info", "debug", "trace"};
+
+static int parse_level(const char* name)
+{
+    for (int level = LOG_ERROR; level <= LOG_TRACE; level++)
+        if (strcasecmp(name, log_level_names[level]) == 0)
+            return level;
+    return -1;
+}
+
+static int parse_module(const char* name)
+{
+    for (int module = 0; module < LOG_MODULES; module++)
+        if (strcasecmp(name, log_module_names[module]) == 0)
+            return module;
+    return -1;
+}
+
+int log_init_levels(int module)
+{
+    for (int i = 0; i < LOG_MODULES; i++)
+        log_levels[i] = LOG_INFO;
+
+    const char* value = getenv("OS_SIM_LOG");
+    if (value)
+    {
+        char setting[256];
+        snprintf(setting, sizeof(setting), "%s", value);
+        for (char* item = strtok(setting, ","); item; item = strtok(NULL, ","))
+        {
+            char* equals = strchr(item, '=');
+            if (equals)
+                *equals = '\0';
+            int level = parse_level(equals ? equals + 1 : item);
+            int target = equals ? parse_module(item) : -1;
+            if (level == -1 || (equals && target == -1))
+            {
+                fprintf(stderr, "Ignoring OS_SIM_LOG entry %s%s%s\n", item, equals ? "=" : "",
+                        equals ? equals + 1 : "");
+                continue;
+            }
+            for (int i = 0; i < LOG_MODULES; i++)
+                if (!equals || i == target)
+                    log_levels[i] = level;
+        }
+    }
+    return log_levels[module];
+}
+
+void log_line(int module, int level, const char* format, ...)
+{
+    FILE* stream = level <= LOG_WARN ? stderr : stdout;
+    va_list args;
+    va_start(args, format);
+    fputs(log_module_colors[module], stream);
+    vfprintf(stream, format, args);
+    fputs(ANSI_COLOR_RESET, stream);
+    va_end(args);
+}
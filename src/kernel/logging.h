@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * Leveled console logging by module.
+ * Lines above the build threshold (make LOG_LEVEL=..., INFO by default)
+ * compile to nothing; the rest are filtered at runtime by OS_SIM_LOG, a level
+ * for every module and/or module=level pairs, e.g. "warn,scheduler=debug".
+ * Warnings and errors go to stderr, the rest to stdout.
+ */
+
+// Levels, each includes the ones before it
+#define LOG_ERROR 0
+#define LOG_WARN 1
+#define LOG_INFO 2
+#define LOG_DEBUG 3 // Per process, slice or message
+#define LOG_TRACE 4 // Per tick
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_INFO
+#endif
+
+// Modules
+#define LOG_CLOCK 0
+#define LOG_SCHEDULER 1
+#define LOG_PROC_GENERATOR 2
+#define LOG_PROCESS 3
+#define LOG_SHARED_MEM 4
+#define LOG_MODULES 5
+
+extern int log_levels[LOG_MODULES]; // Runtime threshold per module, -1 until OS_SIM_LOG is read
+
+// Reads OS_SIM_LOG into log_levels, returns the module's threshold
+int log_init_levels(int module);
+void log_line(int module, int level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+static inline int log_enabled(int module, int level)
+{
+    int threshold = log_levels[module];
+    if (threshold < 0)
+        threshold = log_init_levels(module);
+    return level <= threshold;
+}
+
+#define LOG(module, level, ...) \
+    do \
+    { \
+        if ((level) <= LOG_COMPILE_LEVEL && log_enabled(module, level)) \
+            log_line(module, level, __VA_ARGS__); \
+    } while (0)
@@ -0,0 +1,187 @@
+#include "memory_manager.h"
+#include <stdlib.h>
+#include "buddy_allocator.h"
+#include "deque.h"
+#include "headers.h"
+#include "colors.h"
+#include "logging.h"
+
+extern int flush_log_lines;
+
+int memory_size = DEFAULT_MEMORY_SIZE;
+
+static buddy_allocator_t* buddy = NULL;
+static FILE* memory_log = NULL;
+static Deque waiting_list; // PCB pointers in arrival order
+static int freed_since_scan = 0; // Waiting processes can only fit after a free
+
+// Fragmentation, integrated over time from the moment memory was set up
+static int requested_bytes = 0; // Bytes the admitted processes asked for
+static int allocated_bytes = 0; // Bytes of their blocks
+static int start_time = 0;
+static int stats_time = 0;
+static double internal_area = 0;
+static double external_area = 0;
+static double used_area = 0;
+
+// Memory waits of the processes that needed memory
+static long long total_wait = 0;
+static int admitted_count = 0;
+static int max_waiting = 0;
+
+// Share of the free memory outside the largest free block, in percent
+static double external_fragmentation()
+{
+    int free_bytes = buddy_free_bytes(buddy);
+    return free_bytes ? 100.0 * (free_bytes - buddy_largest_free(buddy)) / free_bytes : 0.0;
+}
+
+static void account(int time)
+{
+    int elapsed = time - stats_time;
+    if (elapsed <= 0)
+        return;
+    internal_area += (double)(allocated_bytes - requested_bytes) * elapsed;
+    external_area += external_fragmentation() * elapsed;
+    used_area += (double)allocated_bytes * elapsed;
+    stats_time = time;
+}
+
+static int init_memory(int time)
+{
+    buddy = create_buddy_allocator(memory_size, MEMORY_MIN_BLOCK);
+    if (!buddy)
+    {
+        LOG(LOG_SCHEDULER, LOG_ERROR, "[MEMORY] Memory size %d is not a power of two\n", memory_size);
+        return -1;
+    }
+    memory_log = fopen("memory.log", "w");
+    if (!memory_log)
+    {
+        perror("Failed to open memory log");
+        return -1;
+    }
+    fprintf(memory_log, "#At\ttime\tx\tallocated\ty\tbytes\tfor\tprocess\tz\tfrom\ti\tto\tj\tinternal\tf\texternal\te\n");
+    initDeque(&waiting_list, sizeof(PCB*));
+    start_time = stats_time = time;
+    return 0;
+}
+
+static void log_memory_event(const char* event, PCB* process, int time, int block_size)
+{
+    fprintf(memory_log, "At time %d %s %d bytes %s process %d from %d to %d internal %d external %.2f%%\n", time,
+            event, process->memsize, event[0] == 'a' ? "for" : "from", process->id, process->mem_address,
+            process->mem_address + block_size - 1, allocated_bytes - requested_bytes, external_fragmentation());
+    if (flush_log_lines)
+        fflush(memory_log);
+}
+
+// Allocates the process's block, returns 0 when no free block is large enough
+static int allocate(PCB* process, int time)
+{
+    int address = buddy_alloc(buddy, process->memsize);
+    if (address == -1)
+        return 0;
+
+    account(time);
+    int block_size = buddy_block_size(buddy, process->memsize);
+    process->mem_address = address;
+    requested_bytes += process->memsize;
+    allocated_bytes += block_size;
+    total_wait += time - process->arrival_time;
+    admitted_count++;
+    log_memory_event("allocated", process, time, block_size);
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[MEMORY] Process %d got %d bytes at %d\n", process->id, block_size, address);
+    return 1;
+}
+
+int memory_fits(int memsize)
+{
+    return memsize <= memory_size;
+}
+
+int memory_admit(PCB* process, int time)
+{
+    process->mem_address = -1;
+    if (process->memsize <= 0)
+        return 1;
+    if (!buddy && init_memory(time) == -1)
+        exit(EXIT_FAILURE);
+
+    // Waiting processes get the first look at freed memory, otherwise none of them fits and it is this one's turn
+    if ((isDequeEmpty(&waiting_list) || !freed_since_scan) && allocate(process, time))
+        return 1;
+
+    pushBack(&waiting_list, &process);
+    if (getDequeSize(&waiting_list) > max_waiting)
+        max_waiting = getDequeSize(&waiting_list);
+    fprintf(memory_log, "At time %d process %d waiting for %d bytes free %d largest %d\n", time, process->id,
+            process->memsize, buddy_free_bytes(buddy), buddy_largest_free(buddy));
+    if (flush_log_lines)
+        fflush(memory_log);
+    return 0;
+}
+
+void memory_release(PCB* process, int time)
+{
+    if (!buddy || process->mem_address < 0)
+        return;
+
+    account(time);
+    int block_size = buddy_free(buddy, process->mem_address);
+    requested_bytes -= process->memsize;
+    allocated_bytes -= block_size;
+    log_memory_event("freed", process, time, block_size);
+    process->mem_address = -1;
+    freed_since_scan = 1;
+}
+
+void memory_admit_waiting(int time, void (*make_ready)(PCB*))
+{
+    if (!buddy || !freed_since_scan)
+        return;
+    freed_since_scan = 0;
+
+    // One pass in arrival order, processes that still do not fit keep their place
+    int waiting = getDequeSize(&waiting_list);
+    for (int i = 0; i < waiting; i++)
+    {
+        PCB* process;
+        popFront(&waiting_list, &process);
+        if (allocate(process, time))
+            make_ready(process);
+        else
+            pushBack(&waiting_list, &process);
+    }
+}
+
+void write_memory_stats(FILE* perf_file, int time)
+{
+    if (!buddy)
+        return;
+    account(time);
+    int span = time > start_time ? time - start_time : 1;
+    fprintf(perf_file, "Avg internal fragmentation = %.2f\n", internal_area / span);
+    fprintf(perf_file, "Avg external fragmentation = %.2f%%\n", external_area / span);
+    fprintf(perf_file, "Avg memory utilization = %.2f%%\n", 100.0 * used_area / span / memory_size);
+    fprintf(perf_file, "Avg memory wait = %.2f\n", admitted_count ? (double)total_wait / admitted_count : 0.0);
+    fprintf(perf_file, "Max memory waiting = %d\n", max_waiting);
+}
+
+void cleanup_memory()
+{
+    if (memory_log)
+    {
+        fclose(memory_log);
+        memory_log = NULL;
+    }
+    if (buddy)
+    {
+        PCB* process;
+        while (popFront(&waiting_list, &process))
+            free(process);
+        clearDeque(&waiting_list);
+        destroy_buddy_allocator(buddy);
+        buddy = NULL;
+    }
+}
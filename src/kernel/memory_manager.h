@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdio.h>
+#include "pcb.h"
+
+#define DEFAULT_MEMORY_SIZE 1024
+#define MEMORY_MIN_BLOCK 1
+
+/*
+ * Simulated physical memory of the scheduler.
+ * A process with a memory size is admitted to the ready queue only once the
+ * buddy allocator finds it a block; until then it waits on a FIFO waiting
+ * list that is rescanned whenever memory is freed. Memory is set up with the
+ * first process that asks for some, processes without a memory size never
+ * touch it. Allocations go to memory.log with the fragmentation after each
+ * change, time-weighted averages go to scheduler.perf.
+ */
+extern int memory_size; // Bytes, a power of two (-m)
+
+// Whether a process of this size can ever be admitted, the generator drops those that cannot
+int memory_fits(int memsize);
+// Returns 1 when the process holds its memory (or needs none) and 0 when it was put on the waiting list
+int memory_admit(PCB* process, int time);
+// Frees the memory of a finished process
+void memory_release(PCB* process, int time);
+// Admits waiting processes that fit now, in arrival order, handing each to make_ready
+void memory_admit_waiting(int time, void (*make_ready)(PCB*));
+// Appends the memory averages to the performance file, nothing when memory was never used
+void write_memory_stats(FILE* perf_file, int time);
+void cleanup_memory();
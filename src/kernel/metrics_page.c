@@ -0,0 +1,53 @@
+#include "metrics_page.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include "colors.h"
+#include "logging.h"
+#include "ipc_keys.h"
+
+extern int scheduler_type;
+
+metrics_page_t* metrics_page = NULL;
+static int metrics_shm_id = -1;
+
+int create_metrics_page(int engine)
+{
+    metrics_shm_id = shmget(ipc_key(METRICS_SHM_KEY), sizeof(metrics_page_t), IPC_CREAT | 0644);
+    if (metrics_shm_id == -1)
+    {
+        perror("Error creating metrics page");
+        return -1;
+    }
+
+    metrics_page_t* page = (metrics_page_t*)shmat(metrics_shm_id, NULL, 0);
+    if ((void*)page == (void*)-1)
+    {
+        perror("Error attaching metrics page");
+        shmctl(metrics_shm_id, IPC_RMID, NULL);
+        metrics_shm_id = -1;
+        return -1;
+    }
+    memset(page, 0, sizeof(metrics_page_t));
+    page->scheduler_pid = getpid();
+    page->engine = engine;
+    page->scheduler_type = scheduler_type;
+    page->live = 1;
+    metrics_page = page;
+    return 0;
+}
+
+void destroy_metrics_page()
+{
+    if (metrics_page == NULL) return;
+
+    metrics_page->running_id = 0;
+    metrics_page->live = 0;
+    shmdt(metrics_page);
+    metrics_page = NULL;
+    shmctl(metrics_shm_id, IPC_RMID, NULL);
+    metrics_shm_id = -1;
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[SCHEDULER] Metrics page removed\n");
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <sys/types.h>
+
+/*
+ * Live metrics page.
+ * The scheduler publishes its state into one shared memory page while it
+ * runs, with plain stores from its own loop, and os-sim-top samples it.
+ * Fields are read one at a time, so a sample may mix two updates.
+ */
+#define METRICS_SHM_KEY 900
+
+// WTA histogram: buckets of 0.1 up to 100, the last one takes everything above
+#define METRICS_WTA_BUCKETS 1000
+#define METRICS_WTA_BUCKET_WIDTH 0.1
+
+typedef struct
+{
+    volatile int live; // 1 while the scheduler publishes, 0 once it finished
+    volatile pid_t scheduler_pid;
+    volatile int engine;
+    volatile int scheduler_type;
+    volatile int tick;
+    // The simulator has one CPU, its running process or 0 while idle
+    volatile int running_id;
+    volatile pid_t running_pid;
+    volatile int running_since; // Tick the running process was dispatched
+    volatile int ready_depth;
+    volatile int processes; // Arrived and not finished
+    volatile int busy_ticks;
+    volatile int idle_ticks;
+    volatile int completions;
+    volatile double wta_sum;
+    volatile int wta_histogram[METRICS_WTA_BUCKETS + 1];
+} metrics_page_t;
+
+extern metrics_page_t* metrics_page; // NULL when not published
+
+// Creates the page for this run of `engine`, returns -1 without it (the run goes on unpublished)
+int create_metrics_page(int engine);
+// Marks the run finished and removes the page, viewers keep their mapping
+void destroy_metrics_page();
+
+// Hot-path updates, no syscalls and nothing but a NULL check when the page is missing
+static inline void metrics_tick(int time, int ready_depth, int processes, int busy_ticks)
+{
+    metrics_page_t* page = metrics_page;
+    if (!page)
+        return;
+    // The running slice is added to the busy time only when it ends
+    if (page->running_id)
+        busy_ticks += time - page->running_since;
+    page->tick = time;
+    page->ready_depth = ready_depth;
+    page->processes = processes;
+    page->busy_ticks = busy_ticks;
+    page->idle_ticks = time > busy_ticks ? time - busy_ticks : 0;
+}
+
+static inline void metrics_dispatch(int id, pid_t pid, int time)
+{
+    metrics_page_t* page = metrics_page;
+    if (!page)
+        return;
+    page->running_since = time;
+    page->running_pid = pid;
+    page->running_id = id;
+}
+
+static inline void metrics_release()
+{
+    if (metrics_page)
+        metrics_page->running_id = 0;
+}
+
+static inline void metrics_finish(double wta)
+{
+    metrics_page_t* page = metrics_page;
+    if (!page)
+        return;
+    int bucket = (int)(wta / METRICS_WTA_BUCKET_WIDTH);
+    if (bucket < 0)
+        bucket = 0;
+    if (bucket > METRICS_WTA_BUCKETS)
+        bucket = METRICS_WTA_BUCKETS;
+    page->wta_histogram[bucket]++;
+    page->wta_sum += wta;
+    page->completions++;
+}
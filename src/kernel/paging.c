@@ -0,0 +1,384 @@
+#include "paging.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory_manager.h"
+#include "headers.h"
+#include "colors.h"
+#include "logging.h"
+
+int vm_policy = VM_NONE;
+int tlb_entries = DEFAULT_TLB_ENTRIES;
+int fault_service_ticks = DEFAULT_FAULT_SERVICE_TICKS;
+
+// Paging state of one process
+typedef struct vm_space
+{
+    int* page_frames; // Frame holding each page, -1 while it is not resident
+    int page_count;
+    int working_set; // Pages one locality spans
+    int locality_base;
+    int locality_left; // References left in the current locality
+    uint64_t rng;
+    long long references; // The process's own virtual time
+    int stall; // Fault service ticks charged but not run yet
+    int stall_total;
+} vm_space_t;
+
+typedef struct
+{
+    vm_space_t* owner; // NULL while the frame is free
+    int page;
+    int referenced;
+    int dirty;
+    long long loaded; // Global reference count when the page came in, FIFO
+    long long last_use; // Global reference count of its last reference, LRU
+    long long owner_last_use; // Owner's reference count of its last reference, WSClock
+} frame_t;
+
+typedef struct
+{
+    vm_space_t* owner; // NULL for an empty entry
+    int page;
+    int frame;
+    long long last_use;
+} tlb_entry_t;
+
+static frame_t* frames = NULL;
+static int frame_count = 0;
+static int* free_frames = NULL; // Stack of free frame numbers
+static int free_count = 0;
+static int hand = 0; // Clock and WSClock
+static tlb_entry_t* tlb = NULL;
+
+static long long total_references = 0;
+static long long tlb_hits = 0;
+static long long page_faults = 0;
+static long long write_backs = 0;
+
+// Finished processes, WTA with and without the fault service time they were charged
+static int finished_count = 0;
+static long long total_stall = 0;
+static double wta_sum = 0;
+static double fault_free_wta_sum = 0;
+
+// splitmix64, same generator as os-sim-gen so reference strings do not depend on the platform
+static uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int parse_vm_policy(const char* name)
+{
+    if (strcmp(name, "fifo") == 0) return VM_FIFO;
+    if (strcmp(name, "lru") == 0) return VM_LRU;
+    if (strcmp(name, "clock") == 0) return VM_CLOCK;
+    if (strcmp(name, "wsclock") == 0) return VM_WSCLOCK;
+    return -1;
+}
+
+static void init_vm()
+{
+    frame_count = memory_size / VM_PAGE_SIZE > 0 ? memory_size / VM_PAGE_SIZE : 1;
+    frames = (frame_t*)calloc(frame_count, sizeof(frame_t));
+    free_frames = (int*)malloc(sizeof(int) * frame_count);
+    tlb = (tlb_entry_t*)calloc(tlb_entries, sizeof(tlb_entry_t));
+    if (!frames || !free_frames || !tlb)
+    {
+        perror("Failed to allocate paging state");
+        exit(EXIT_FAILURE);
+    }
+    // Lowest frames are handed out first
+    for (int i = 0; i < frame_count; i++)
+        free_frames[i] = frame_count - 1 - i;
+    free_count = frame_count;
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[PAGING] %d frames of %d bytes, %d TLB entries\n", frame_count, VM_PAGE_SIZE,
+        tlb_entries);
+}
+
+static vm_space_t* attach(PCB* process)
+{
+    vm_space_t* vm = (vm_space_t*)malloc(sizeof(vm_space_t));
+    if (!vm)
+    {
+        perror("Failed to allocate paging state");
+        exit(EXIT_FAILURE);
+    }
+    if (process->memsize > 0)
+        vm->page_count = (process->memsize + VM_PAGE_SIZE - 1) / VM_PAGE_SIZE;
+    else
+        vm->page_count = process->runtime + 4 < VM_MAX_PAGES ? process->runtime + 4 : VM_MAX_PAGES;
+    vm->page_frames = (int*)malloc(sizeof(int) * vm->page_count);
+    if (!vm->page_frames)
+    {
+        perror("Failed to allocate page table");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < vm->page_count; i++)
+        vm->page_frames[i] = -1;
+    vm->working_set = (vm->page_count + 3) / 4;
+    vm->locality_left = 0;
+    vm->rng = (uint64_t)process->id * 0x9E3779B97F4A7C15ULL ^ 0x7061676573ULL;
+    vm->references = 0;
+    vm->stall = 0;
+    vm->stall_total = 0;
+    process->vm = vm;
+    return vm;
+}
+
+// Next page of the reference string, a quarter of the references write
+static int next_page(vm_space_t* vm, int* write)
+{
+    if (vm->locality_left == 0)
+    {
+        vm->locality_base = (int)(splitmix64(&vm->rng) % vm->page_count);
+        vm->locality_left = VM_PHASE_REFERENCES;
+    }
+    vm->locality_left--;
+    uint64_t random = splitmix64(&vm->rng);
+    *write = ((random >> 32) & 3) == 0;
+    return (vm->locality_base + (int)(random % vm->working_set)) % vm->page_count;
+}
+
+static int tlb_lookup(vm_space_t* vm, int page)
+{
+    for (int i = 0; i < tlb_entries; i++)
+    {
+        if (tlb[i].owner == vm && tlb[i].page == page)
+        {
+            tlb[i].last_use = total_references;
+            return tlb[i].frame;
+        }
+    }
+    return -1;
+}
+
+// Fills an empty entry, or the least recently used one
+static void tlb_insert(vm_space_t* vm, int page, int frame)
+{
+    int victim = 0;
+    for (int i = 0; i < tlb_entries; i++)
+    {
+        if (!tlb[i].owner)
+        {
+            victim = i;
+            break;
+        }
+        if (tlb[i].last_use < tlb[victim].last_use)
+            victim = i;
+    }
+    tlb[victim] = (tlb_entry_t){vm, page, frame, total_references};
+}
+
+// Drops the entries of a page, or of every page of the process when page is -1
+static void tlb_invalidate(vm_space_t* vm, int page)
+{
+    for (int i = 0; i < tlb_entries; i++)
+        if (tlb[i].owner == vm && (page == -1 || tlb[i].page == page))
+            tlb[i].owner = NULL;
+}
+
+static int oldest_frame(int by_last_use)
+{
+    int victim = 0;
+    for (int i = 1; i < frame_count; i++)
+    {
+        long long age = by_last_use ? frames[i].last_use : frames[i].loaded;
+        if (age < (by_last_use ? frames[victim].last_use : frames[victim].loaded))
+            victim = i;
+    }
+    return victim;
+}
+
+static int clock_victim()
+{
+    while (1)
+    {
+        int victim = hand;
+        hand = (hand + 1) % frame_count;
+        if (!frames[victim].referenced)
+            return victim;
+        frames[victim].referenced = 0;
+    }
+}
+
+/*
+ * One lap of the hand: referenced pages get another chance, the first clean
+ * page that left its owner's working set is the victim. Old dirty pages are
+ * written back on the way and taken if the lap finds nothing clean; with no
+ * old page at all the frame under the hand goes.
+ */
+static int wsclock_victim()
+{
+    int start = hand;
+    int written = -1;
+    for (int scanned = 0; scanned < frame_count; scanned++)
+    {
+        int frame = hand;
+        hand = (hand + 1) % frame_count;
+        frame_t* candidate = &frames[frame];
+        if (candidate->referenced)
+        {
+            candidate->referenced = 0;
+            continue;
+        }
+        if (candidate->owner->references - candidate->owner_last_use <= VM_WSCLOCK_TAU)
+            continue;
+        if (!candidate->dirty)
+            return frame;
+        candidate->dirty = 0;
+        write_backs++;
+        if (written == -1)
+            written = frame;
+    }
+    if (written != -1)
+        return written;
+    hand = (start + 1) % frame_count;
+    return start;
+}
+
+static int choose_victim()
+{
+    switch (vm_policy)
+    {
+    case VM_FIFO:
+        return oldest_frame(0);
+    case VM_LRU:
+        return oldest_frame(1);
+    case VM_CLOCK:
+        return clock_victim();
+    default:
+        return wsclock_victim();
+    }
+}
+
+// Brings the page into a free frame or the policy's victim
+static int fault_in(vm_space_t* vm, int page)
+{
+    page_faults++;
+    int frame;
+    if (free_count > 0)
+        frame = free_frames[--free_count];
+    else
+    {
+        frame = choose_victim();
+        frame_t* victim = &frames[frame];
+        victim->owner->page_frames[victim->page] = -1;
+        tlb_invalidate(victim->owner, victim->page);
+        if (victim->dirty)
+            write_backs++;
+    }
+    frames[frame] = (frame_t){vm, page, 0, 0, total_references, total_references, vm->references};
+    vm->page_frames[page] = frame;
+    return frame;
+}
+
+// Returns 1 when the reference faulted
+static int reference(vm_space_t* vm, int page, int write)
+{
+    total_references++;
+    vm->references++;
+    int faulted = 0;
+    int frame = tlb_lookup(vm, page);
+    if (frame >= 0)
+        tlb_hits++;
+    else
+    {
+        frame = vm->page_frames[page];
+        if (frame < 0)
+        {
+            frame = fault_in(vm, page);
+            faulted = 1;
+        }
+        tlb_insert(vm, page, frame);
+    }
+    frames[frame].referenced = 1;
+    frames[frame].dirty |= write;
+    frames[frame].last_use = total_references;
+    frames[frame].owner_last_use = vm->references;
+    return faulted;
+}
+
+int vm_run(PCB* process, int ticks)
+{
+    if (vm_policy == VM_NONE || ticks <= 0)
+        return 0;
+    if (!frames)
+        init_vm();
+    vm_space_t* vm = process->vm ? process->vm : attach(process);
+
+    int stalled = vm->stall < ticks ? vm->stall : ticks;
+    vm->stall -= stalled;
+    int faults = 0;
+    int references = (ticks - stalled) * VM_REFERENCES_PER_TICK;
+    for (int i = 0; i < references; i++)
+    {
+        int write;
+        int page = next_page(vm, &write);
+        faults += reference(vm, page, write);
+    }
+
+    int charged = faults * fault_service_ticks;
+    vm->stall += charged;
+    vm->stall_total += charged;
+    return charged;
+}
+
+void vm_release(PCB* process, int time)
+{
+    vm_space_t* vm = process->vm;
+    if (!vm)
+        return;
+
+    if (process->runtime > 0)
+    {
+        int turnaround = time - process->arrival_time;
+        wta_sum += (double)turnaround / process->runtime;
+        fault_free_wta_sum += (double)(turnaround - vm->stall_total) / process->runtime;
+        total_stall += vm->stall_total;
+        finished_count++;
+    }
+
+    tlb_invalidate(vm, -1);
+    for (int page = 0; page < vm->page_count; page++)
+    {
+        int frame = vm->page_frames[page];
+        if (frame < 0)
+            continue;
+        frames[frame].owner = NULL;
+        free_frames[free_count++] = frame;
+    }
+    free(vm->page_frames);
+    free(vm);
+    process->vm = NULL;
+}
+
+void write_vm_stats(FILE* perf_file)
+{
+    if (vm_policy == VM_NONE)
+        return;
+    double references = total_references ? (double)total_references : 1.0;
+    double avg_wta = finished_count ? wta_sum / finished_count : 0.0;
+    double fault_free_wta = finished_count ? fault_free_wta_sum / finished_count : 0.0;
+    fprintf(perf_file, "Page references = %lld\n", total_references);
+    fprintf(perf_file, "TLB hit rate = %.2f%%\n", 100.0 * tlb_hits / references);
+    fprintf(perf_file, "Page fault rate = %.2f%%\n", 100.0 * page_faults / references);
+    fprintf(perf_file, "Page write-backs = %lld\n", write_backs);
+    fprintf(perf_file, "Avg fault service time = %.2f\n", finished_count ? (double)total_stall / finished_count : 0.0);
+    fprintf(perf_file, "Avg WTA without fault service = %.2f\n", fault_free_wta);
+    fprintf(perf_file, "WTA inflation from faults = %.2f%%\n",
+            fault_free_wta > 0 ? 100.0 * (avg_wta / fault_free_wta - 1) : 0.0);
+}
+
+void cleanup_vm()
+{
+    free(frames);
+    free(free_frames);
+    free(tlb);
+    frames = NULL;
+    free_frames = NULL;
+    tlb = NULL;
+}
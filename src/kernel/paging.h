@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdio.h>
+#include "pcb.h"
+
+// Page replacement policies (--vm)
+#define VM_NONE 0
+#define VM_FIFO 1
+#define VM_LRU 2
+#define VM_CLOCK 3
+#define VM_WSCLOCK 4
+
+#define VM_PAGE_SIZE 16 // Bytes, physical memory holds memory_size / VM_PAGE_SIZE frames
+#define VM_MAX_PAGES 64 // Pages of a process without a memory size, which get 4 + runtime
+#define VM_REFERENCES_PER_TICK 16
+#define VM_PHASE_REFERENCES 64 // References before a process moves to another locality
+#define VM_WSCLOCK_TAU 64 // References of its owner after which an unreferenced page leaves the working set
+#define DEFAULT_TLB_ENTRIES 16
+#define DEFAULT_FAULT_SERVICE_TICKS 1
+
+/*
+ * Demand paging of the simulated processes.
+ * Every process gets a page table over its pages and a seeded synthetic
+ * reference string with phases of locality, VM_REFERENCES_PER_TICK
+ * references for each tick it runs. References go through a small fully
+ * associative TLB tagged by process, misses walk the page table and pages
+ * that are not resident fault into one of the global frames, evicting a
+ * victim chosen by the replacement policy when none is free. Each fault
+ * charges the process fault_service_ticks of CPU time, which it runs before
+ * its next references. Nothing is simulated while vm_policy is VM_NONE.
+ */
+extern int vm_policy;
+extern int tlb_entries;
+extern int fault_service_ticks;
+
+// VM_NONE..VM_WSCLOCK for fifo, lru, clock or wsclock, -1 for anything else
+int parse_vm_policy(const char* name);
+/*
+ * Runs `ticks` ticks of the process: fault service time it still owes comes
+ * first, the rest makes references. Returns the fault service ticks the new
+ * faults add, which the caller adds to the process's remaining time.
+ */
+int vm_run(PCB* process, int ticks);
+// Frees the frames and page table of a finished process and records its WTA with and without fault service
+void vm_release(PCB* process, int time);
+// Appends the TLB and fault statistics to the performance file, nothing when paging is off
+void write_vm_stats(FILE* perf_file);
+void cleanup_vm();
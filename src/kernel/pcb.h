@@ -1,5 +1,7 @@
 #pragma once
 
+#include "accounting.h"
+
 // Process Control Block (PCB)
 typedef struct {
     long mtype;
@@ -17,4 +19,15 @@ typedef struct {
     int turnaround_time;
     float weighted_turnaround;
     int status;
+    int memsize; // Bytes of simulated memory, 0 when the process needs none
+    int mem_address; // Start of its memory block, -1 while it holds none
+    int io_interval; // CPU ticks between I/O requests, 0 for a CPU-bound process
+    int io_device;
+    int burst_ran; // CPU ticks since its last I/O request
+    int channel; // Command channel of the process running it, -1 in the des engine
+    struct vm_space* vm; // Paging state, NULL until it first runs with --vm
+    process_account_t account; // Ticks per state, zeroed by the initializers
+#if defined(OS_SIM_BENCH) || defined(OS_SIM_LATENCY)
+    long long sent_ns; // When the generator sent the arrival message
+#endif
 } PCB;
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <unistd.h>    // for fork, execl
@@ -11,23 +13,61 @@
 #include <string.h>
 #include <sys/wait.h>
 #include "colors.h"
+#include "logging.h"
 
 #include "scheduler.h"
-#include <bits/getopt_core.h>
+#include "process_pool.h"
+#include "process_host.h"
+#include "des_engine.h"
+#include "host_engine.h"
+#include "workload.h"
+#include "ipc_keys.h"
+#include "bench.h"
+#include "latency.h"
+#include "timing_wheel.h"
+#include "memory_manager.h"
+#include "paging.h"
+#include "io_devices.h"
+#include "disk_scheduler.h"
+#include "command_channel.h"
+#include "arrival_queue.h"
+#include <getopt.h>
 int scheduler_type = -1; // Default invalid value
 char* process_file = "processes.txt"; // Default filename
 int quantum = 2; // Default quantum value
-processParameters** process_parameters;
+int pool_size = 0; // Number of pre-spawned workers, 0 forks a process per arrival
+process_pool_t* process_pool = NULL;
+int use_coroutine_host = 0; // Run every job as a coroutine inside one host process
+process_host_t* process_host = NULL;
+int engine = ENGINE_PROCESSES;
+workload_reader_t workload;
 int msgid;
-key_t key;
 
-int main(int argc, char* argv[])
+// Pending arrival of the generator, the next workload record timed on the wheel
+typedef struct
 {
-    int process_count;
+    timing_wheel_t* wheel;
+    processParameters next;
+    pid_t process_generator_pid;
+} arrival_stream_t;
+
+static void send_arrival(void* data, int expires, void* context);
+static void send_arrivals_through(timing_wheel_t* wheel);
 
+int main(int argc, char* argv[])
+{
     // Parse command line arguments
     int opt;
-    while ((opt = getopt(argc, argv, "s:f:q:")) != -1)
+    static struct option long_options[] = {
+        {"engine", required_argument, NULL, 'e'},
+        {"vm", required_argument, NULL, 'V'},
+        {"tlb", required_argument, NULL, 'T'},
+        {"fault-ticks", required_argument, NULL, 'F'},
+        {"devices", required_argument, NULL, 'D'},
+        {"disk", required_argument, NULL, 'K'},
+        {NULL, 0, NULL, 0}
+    };
+    while ((opt = getopt_long(argc, argv, "s:f:q:p:cm:e:", long_options, NULL)) != -1)
     {
         switch (opt)
         {
@@ -50,18 +90,100 @@ int main(int argc, char* argv[])
                 fprintf(stderr, "Valid options are: rr, hpf, srtn\n");
                 exit(EXIT_FAILURE);
             }
-            printf(ANSI_COLOR_MAGENTA"[MAIN] Using scheduler: %s\n"ANSI_COLOR_RESET, optarg);
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Using scheduler: %s\n", optarg);
             break;
         case 'f':
             process_file = optarg;
-            printf(ANSI_COLOR_MAGENTA"[MAIN] Reading processes from: %s\n"ANSI_COLOR_RESET, process_file);
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Reading processes from: %s\n", process_file);
             break;
         case 'q':
             quantum = atoi(optarg);
-            printf(ANSI_COLOR_MAGENTA"[MAIN] Quantum set to: %d\n"ANSI_COLOR_RESET, quantum);
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Quantum set to: %d\n", quantum);
+            break;
+        case 'p':
+            pool_size = atoi(optarg);
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Process pool size set to: %d\n", pool_size);
+            break;
+        case 'c':
+            use_coroutine_host = 1;
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Running processes as coroutines in one host\n");
+            break;
+        case 'm':
+            memory_size = atoi(optarg);
+            if (memory_size <= 0 || (memory_size & (memory_size - 1)))
+            {
+                fprintf(stderr, "Memory size must be a power of two: %s\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Memory size set to: %d bytes\n", memory_size);
+            break;
+        case 'e':
+            if (strcmp(optarg, "des") == 0)
+                engine = ENGINE_DES;
+            else if (strcmp(optarg, "proc") == 0)
+                engine = ENGINE_PROCESSES;
+            else if (strcmp(optarg, "host") == 0)
+                engine = ENGINE_HOST;
+            else
+            {
+                fprintf(stderr, "Invalid engine: %s\n", optarg);
+                fprintf(stderr, "Valid options are: proc, des, host\n");
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Using engine: %s\n", optarg);
+            break;
+        case 'V':
+            vm_policy = parse_vm_policy(optarg);
+            if (vm_policy == -1)
+            {
+                fprintf(stderr, "Invalid page replacement policy: %s\n", optarg);
+                fprintf(stderr, "Valid options are: fifo, lru, clock, wsclock\n");
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Paging with replacement policy: %s\n", optarg);
+            break;
+        case 'T':
+            tlb_entries = atoi(optarg);
+            if (tlb_entries <= 0)
+            {
+                fprintf(stderr, "TLB entries must be positive: %s\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] TLB entries set to: %d\n", tlb_entries);
+            break;
+        case 'F':
+            fault_service_ticks = atoi(optarg);
+            if (fault_service_ticks < 0)
+            {
+                fprintf(stderr, "Fault service time cannot be negative: %s\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Page fault service time set to: %d\n", fault_service_ticks);
+            break;
+        case 'D':
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] I/O device service times: %s\n", optarg);
+            if (parse_io_devices(optarg) == -1)
+            {
+                fprintf(stderr, "Device service times must be 1 to %d positive tick counts\n", MAX_IO_DEVICES);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'K':
+            disk_policy = parse_disk_policy(optarg);
+            if (disk_policy == -1)
+            {
+                fprintf(stderr, "Invalid disk scheduling policy: %s\n", optarg);
+                fprintf(stderr, "Valid options are: fcfs, sstf, scan, clook\n");
+                exit(EXIT_FAILURE);
+            }
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] Disk scheduling policy: %s\n", optarg);
             break;
         default:
-            fprintf(stderr, "Usage: %s -s <scheduling-algorithm> -f <processes-text-file> [-q <quantum>]\n", argv[0]);
+            fprintf(stderr,
+                    "Usage: %s -s <scheduling-algorithm> -f <processes-text-file> [-q <quantum>] [-p <pool-size>] [-c]"
+                    " [-m <memory-size>] [--engine=proc|des|host] [--vm=fifo|lru|clock|wsclock] [--tlb=<entries>]"
+                    " [--fault-ticks=<ticks>] [--devices=<ticks>[,<ticks>...]] [--disk=fcfs|sstf|scan|clook]\n",
+                    argv[0]);
             exit(EXIT_FAILURE);
         }
     }
@@ -74,18 +196,45 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
-    // Get List of processes
-    process_parameters = read_process_file(process_file, &process_count);
+    // The jobs of the multi-process engine run their own runtime and cannot be charged fault service time
+    if (vm_policy != VM_NONE && engine != ENGINE_DES)
+    {
+        fprintf(stderr, "Paging (--vm) is simulated by the des engine only\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The host engine's file lists commands, it reads it itself
+    if (engine == ENGINE_HOST)
+    {
+        run_host_engine(process_file);
+        return 0;
+    }
+
+    // Map the process file, records are parsed as their arrival time comes
+    if (workload_open(&workload, process_file) == -1)
+    {
+        perror(ANSI_COLOR_MAGENTA"[MAIN] Error opening file"ANSI_COLOR_RESET);
+        exit(1);
+    }
+
+    if (engine == ENGINE_DES)
+    {
+        run_des_engine(&workload);
+        workload_close(&workload);
+        return 0;
+    }
 
     // Init IPC
-    // Any file name
-    key = ftok("process_generator", 65);
-    msgid = msgget(key, 0666 | IPC_CREAT);
+    msgid = msgget(ipc_key(MSG_QUEUE_KEY), 0666 | IPC_CREAT);
     if (msgid == -1)
     {
         perror("Error creating message queue");
         exit(1);
     }
+    // Every process gets a command channel, the generator claims them and the scheduler rings them
+    channel_table = create_channel_table();
+    if (channel_table == NULL)
+        exit(1);
 
     /*
      * Fork -> sends the processes at the appropriate time to the scheduler
@@ -105,75 +254,33 @@ int main(int argc, char* argv[])
             signal(SIGCHLD, child_process_handler);
             sync_clk();
 
-            int remaining_processes = process_count;
-            int crt_clk = get_clk();
-            int old_clk = -1;
-            while (remaining_processes > 0)
+            if (use_coroutine_host)
+                process_host = create_process_host(process_generator_pid);
+            else if (pool_size > 0)
+                process_pool = create_process_pool(pool_size, process_generator_pid);
+
+            // Arrivals are timers on a wheel, only the next record of the file is pending at a time
+            arrival_stream_t stream = {create_timing_wheel(get_clk()), {0}, process_generator_pid};
+            if (workload_next(&workload, &stream.next))
+                timing_wheel_schedule(stream.wheel, stream.next.arrival_time, NULL);
+            send_arrivals_through(stream.wheel);
+
+            while (!timing_wheel_is_empty(stream.wheel))
             {
-                // 0 1 2 3 4
-                // Ensure that we move by increments of 1
-                while ((crt_clk = get_clk()) - old_clk == 0);
-                old_clk = crt_clk;
-
-                int messages_sent = 0;
-                // Check the process_parameters[] for processes whose arrival time == crt_clk, and fork/send them
-                for (int i = 0; i < process_count; i++)
-                {
-                    if (process_parameters[i] != NULL && process_parameters[i]->arrival_time == crt_clk)
-                    {
-                        // Fork the process at its arrival time
-                        pid_t pid = fork();
-                        if (pid == 0)
-                        {
-                            char runtime_str[16];
-                            snprintf(runtime_str, sizeof(runtime_str), "%d", process_parameters[i]->runtime);
-                            char pid_str[16];
-                            snprintf(pid_str, sizeof(pid_str), "%d", process_generator_pid);
-                            // printf("[CHILD A] Sending Pid: %d\n", process_generator_pid);
-                            execl("./process", "process", runtime_str, pid_str, (char*)NULL);
-                            perror("execl failed");
-                            exit(1);
-                        }
-                        else if (pid > 0)
-                        {
-                            process_parameters[i]->pid = pid;
-                            // kill(pid, SIGTSTP); // Immediately stop the child process
-                        }
-                        else
-                        {
-                            perror("fork failed");
-                        }
-
-                        messages_sent++;
-                        PCB proc_pcb = {
-                            1, process_parameters[i]->id, process_parameters[i]->pid,
-                            process_parameters[i]->arrival_time, process_parameters[i]->runtime,
-                            process_parameters[i]->runtime, process_parameters[i]->priority, 0, -1, -1, -1, -1, -1,
-                            -1,
-                            READY,
-                        };
-                        // Send the message
-                        if (msgsnd(msgid, &proc_pcb, sizeof(PCB), 0) == -1)
-                        {
-                            if (DEBUG)
-                                perror("Error sending message");
-                        }
-
-                        // Cleanup
-                        free(process_parameters[i]);
-                        process_parameters[i] = NULL;
-                        remaining_processes--;
-                    }
-                    else if (process_parameters[i] != NULL && process_parameters[i]->arrival_time > crt_clk)
-                        break;
-                }
-
-                if (messages_sent > 0 && DEBUG)
-                    printf(ANSI_COLOR_MAGENTA"[MAIN] Sent %d message(s) to scheduler\n"ANSI_COLOR_RESET, messages_sent);
+                // Sleep until the tick of the next arrival, then send every arrival due by now
+                int crt_clk = wait_clk(timing_wheel_next_expiry(stream.wheel));
+                int messages_sent = timing_wheel_advance(stream.wheel, crt_clk, send_arrival, &stream);
+                send_arrivals_through(stream.wheel);
+                if (messages_sent > 0)
+                    LOG(LOG_PROC_GENERATOR, LOG_DEBUG, "[MAIN] Sent %d message(s) to scheduler\n", messages_sent);
             }
+            destroy_timing_wheel(stream.wheel);
 
-            if (DEBUG)
-                printf(ANSI_COLOR_MAGENTA"[MAIN] All processes have been sent, exiting...\n"ANSI_COLOR_RESET);
+            LOG(LOG_PROC_GENERATOR, LOG_INFO, "[MAIN] All processes have been sent, exiting...\n");
+            destroy_process_pool(process_pool);
+            process_pool = NULL;
+            destroy_process_host(process_host);
+            process_host = NULL;
             process_generator_cleanup(0);
             // Make the process generator untill all children exited
             // Wait for all child processes to exit before terminating
@@ -190,8 +297,7 @@ int main(int argc, char* argv[])
     }
     else
     {
-        if (DEBUG)
-            printf(ANSI_COLOR_MAGENTA"[MAIN] Running Scheduler with pid: %d\n"ANSI_COLOR_RESET, getpid());
+        LOG(LOG_PROC_GENERATOR, LOG_DEBUG, "[MAIN] Running Scheduler with pid: %d\n", getpid());
         run_scheduler();
     }
 
@@ -199,83 +305,95 @@ int main(int argc, char* argv[])
 }
 
 /*
- * Reads the input file and returns a ProcessMessage**, a pointer to an
- * array of ProcessMessage, of size MAX_INPUT_PROCESSES
+ * Fires at a record's arrival tick: starts its process, sends its PCB to the
+ * scheduler and times the next record, which fires within the same advance
+ * when it arrives at the same tick.
  */
-processParameters** read_process_file(const char* filename, int* count)
+static void send_arrival(void* data, int expires, void* context)
 {
-    FILE* file = fopen(filename, "r");
-
-    if (!file)
+    (void)data;
+    (void)expires;
+    arrival_stream_t* stream = (arrival_stream_t*)context;
+    processParameters* next_process = &stream->next;
+    if (!memory_fits(next_process->memsize))
     {
-        perror(ANSI_COLOR_MAGENTA"[MAIN] Error opening file"ANSI_COLOR_RESET);
-        exit(1);
+        LOG(LOG_PROC_GENERATOR, LOG_WARN, "[MAIN] Dropping process %d: %d bytes never fit in %d bytes of memory\n",
+            next_process->id, next_process->memsize, memory_size);
+        if (workload_next(&workload, next_process))
+            timing_wheel_schedule(stream->wheel, next_process->arrival_time, NULL);
+        return;
     }
+    int channel = channel_claim(channel_table);
+    next_process->pid = spawn_process(next_process, channel, stream->process_generator_pid);
+
+    PCB proc_pcb = {
+        .mtype = 1, .id = next_process->id, .pid = next_process->pid,
+        .arrival_time = next_process->arrival_time, .runtime = next_process->runtime,
+        .remaining_time = next_process->runtime, .priority = next_process->priority, .waiting_time = 0,
+        .start_time = -1, .last_run_time = -1, .finish_time = -1, .response_time = -1, .turnaround_time = -1,
+        .weighted_turnaround = -1,
+        .status = READY, .memsize = next_process->memsize, .mem_address = -1, .io_interval = next_process->io_interval,
+        .io_device = next_process->io_device, .burst_ran = 0, .channel = channel, .vm = NULL, // The account starts zeroed
+    };
+#ifdef OS_SIM_BENCH
+    proc_pcb.sent_ns = bench_now_ns();
+#endif
+    LATENCY_STAMP(proc_pcb.sent_ns);
+    // Send the message
+    if (msgsnd(msgid, &proc_pcb, sizeof(PCB) - sizeof(long), 0) == -1)
+        LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Error sending message: %s\n", strerror(errno));
+
+    if (workload_next(&workload, next_process))
+        timing_wheel_schedule(stream->wheel, next_process->arrival_time, NULL);
+}
 
-    // Count lines to allocate memory
-    char line[100];
-    int line_count = 0;
+/*
+ * Sends the tick marker after the arrivals just sent: every arrival before
+ * the next pending record is in the queue, all of them once none is left.
+ */
+static void send_arrivals_through(timing_wheel_t* wheel)
+{
+    PCB marker = {
+        .mtype = ARRIVALS_THROUGH_MSG,
+        .arrival_time = timing_wheel_is_empty(wheel) ? INT_MAX : timing_wheel_next_expiry(wheel) - 1,
+    };
+    if (msgsnd(msgid, &marker, sizeof(PCB) - sizeof(long), 0) == -1)
+        LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Error sending tick marker: %s\n", strerror(errno));
+}
 
-    while (fgets(line, sizeof(line), file))
-    {
-        // Skip comment lines that start with #
-        if (line[0] != '#' && line[0] != '\n')
-        {
-            line_count++;
-        }
-    }
+/*
+ * Starts the process for an arrival, either by queueing it on the coroutine
+ * host, handing it to an idle pool worker or forking a fresh ./process.
+ * Returns the pid running the job.
+ */
+pid_t spawn_process(processParameters* params, int channel, pid_t process_generator_pid)
+{
+    if (process_host)
+        return host_assign(process_host, params->id, params->runtime, channel);
 
-    // Allocate memory for process message pointers
-    /// Assuming a maximum of MAX_INPUT_PROCESSES processes
-    processParameters** process_messages = (processParameters**)
-        malloc(MAX_INPUT_PROCESSES * sizeof(processParameters*));
+    pid_t pid = pool_assign(process_pool, params->id, params->runtime, channel);
+    if (pid > 0)
+        return pid;
 
-    // Initialize all pointers to NULL
-    for (int i = 0; i < MAX_INPUT_PROCESSES; i++)
+    // Fork the process at its arrival time
+    pid = fork();
+    if (pid == 0)
     {
-        process_messages[i] = NULL;
+        char runtime_str[16];
+        snprintf(runtime_str, sizeof(runtime_str), "%d", params->runtime);
+        char pid_str[16];
+        snprintf(pid_str, sizeof(pid_str), "%d", process_generator_pid);
+        char channel_str[16];
+        snprintf(channel_str, sizeof(channel_str), "%d", channel);
+        execl("./process", "process", runtime_str, pid_str, channel_str, (char*)NULL);
+        perror("execl failed");
+        exit(1);
     }
-
-    *count = line_count;
-
-    // Reset file pointer to beginning
-    rewind(file);
-
-    // Read process data
-    int index = 0;
-
-    while (fgets(line, sizeof(line), file))
+    else if (pid < 0)
     {
-        // Skip comment lines that start with #
-        if (line[0] == '#' || line[0] == '\n')
-        {
-            continue;
-        }
-
-        // Parse process information
-        int id, arrival, runtime, priority;
-        if (sscanf(line, "%d\t%d\t%d\t%d", &id, &arrival, &runtime, &priority) == 4)
-        {
-            // Allocate memory for each ProcessMessage
-            process_messages[index] = (processParameters*)malloc(sizeof(processParameters));
-
-            // Set values
-            process_messages[index]->mtype = 1; // Default message type
-            process_messages[index]->id = id;
-            process_messages[index]->arrival_time = arrival;
-            process_messages[index]->runtime = runtime;
-            process_messages[index]->priority = priority;
-
-            index++;
-        }
+        perror("fork failed");
     }
-
-    fclose(file);
-
-    if (DEBUG)
-        printf(ANSI_COLOR_BLUE"[PROC_GENERATOR] Read %d processes from file\n"ANSI_COLOR_RESET, index);
-
-    return process_messages;
+    return pid;
 }
 
 void child_process_handler(int signum)
@@ -286,10 +404,7 @@ void child_process_handler(int signum)
     // Reap all terminated children
     while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
     {
-        if (DEBUG)
-            printf(
-                ANSI_COLOR_BLUE"[PROC_GENERATOR] Acknowledged that child process PID: %d has died.\n"ANSI_COLOR_RESET,
-                pid);
+        LOG(LOG_PROC_GENERATOR, LOG_DEBUG, "[PROC_GENERATOR] Acknowledged that child process PID: %d has died.\n", pid);
     }
 }
 
@@ -297,18 +412,7 @@ void process_generator_cleanup(int signum)
 {
     signal(signum, process_generator_cleanup);
 
-    // Free each ProcessMessage
-    for (int i = 0; i < process_count; i++)
-    {
-        if (process_parameters[i] != NULL)
-        {
-            free(process_parameters[i]);
-            process_parameters[i] = NULL;
-        }
-    }
-
-    if (process_parameters != NULL)
-        free(process_parameters);
+    workload_close(&workload);
 
     // Wait until message queue is empty before removing it
     if (msgid != -1)
@@ -320,24 +424,20 @@ void process_generator_cleanup(int signum)
         {
             if (msgctl(msgid, IPC_STAT, &queue_info) == -1)
             {
-                if (DEBUG)
-                    perror("Error getting message queue stats");
+                LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Error getting message queue stats: %s\n",
+                    strerror(errno));
                 break;
             }
 
             // If no messages are left in the queue, we can safely remove it
             if (queue_info.msg_qnum == 0)
             {
-                if (DEBUG)
-                    printf(ANSI_COLOR_BLUE"[PROC_GENERATOR] Message queue is empty, removing it\n"ANSI_COLOR_RESET);
+                LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Message queue is empty, removing it\n");
                 break;
             }
 
-            if (DEBUG)
-                printf(
-                    ANSI_COLOR_BLUE"[PROC_GENERATOR] Waiting for queue to empty: %ld messages remaining\n"
-                    ANSI_COLOR_RESET,
-                    queue_info.msg_qnum);
+            LOG(LOG_PROC_GENERATOR, LOG_DEBUG, "[PROC_GENERATOR] Waiting for queue to empty: %ld messages remaining\n",
+                queue_info.msg_qnum);
         }
 
         // remove the message queue if still exists
@@ -346,14 +446,12 @@ void process_generator_cleanup(int signum)
         {
             msgctl(msgid, IPC_RMID, NULL);
             msgid = -1;
-            if (DEBUG)
-                printf(ANSI_COLOR_BLUE"[PROC_GENERATOR] Message queue removed successfully\n"ANSI_COLOR_RESET);
+            LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Message queue removed successfully\n");
         }
     }
 
     destroy_clk(0);
-    if (DEBUG)
-        printf(ANSI_COLOR_BLUE"[PROC_GENERATOR] Resources cleaned up\n"ANSI_COLOR_RESET);
+    LOG(LOG_PROC_GENERATOR, LOG_INFO, "[PROC_GENERATOR] Resources cleaned up\n");
 
     if (signum != 0)
     {
@@ -1,6 +1,8 @@
 #pragma once
 
-processParameters** read_process_file(const char* filename, int* count);
+#include <sys/types.h>
+
 void process_generator_cleanup(int signum);
+pid_t spawn_process(processParameters* params, int channel, pid_t process_generator_pid);
 extern int quantum;
 void child_process_handler(int signum);
@@ -0,0 +1,104 @@
+#include "process_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include "colors.h"
+#include "logging.h"
+#include "ipc_keys.h"
+#include "futex.h"
+
+int host_shm_id = -1;
+
+/*
+ * Creates the host's arrival ring in shared memory and starts the single
+ * ./process host that runs every job as a coroutine.
+ */
+process_host_t* create_process_host(pid_t scheduler_pid)
+{
+    host_shm_id = shmget(ipc_key(HOST_SHM_KEY), sizeof(process_host_t), IPC_CREAT | 0666);
+    if (host_shm_id == -1)
+    {
+        perror("Error creating process host shared memory");
+        return NULL;
+    }
+
+    process_host_t* host = (process_host_t*)shmat(host_shm_id, NULL, 0);
+    if ((void*)host == (void*)-1)
+    {
+        perror("Error attaching process host shared memory");
+        shmctl(host_shm_id, IPC_RMID, NULL);
+        host_shm_id = -1;
+        return NULL;
+    }
+
+    host->pid = -1;
+    host->head = 0;
+    host->tail = 0;
+    host->done = 0;
+    host->bell = 0;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        char pid_str[16];
+        snprintf(pid_str, sizeof(pid_str), "%d", scheduler_pid);
+        execl("./process", "process", "-c", pid_str, (char*)NULL);
+        perror("execl failed");
+        exit(1);
+    }
+    else if (pid < 0)
+    {
+        perror("fork failed");
+        shmdt(host);
+        shmctl(host_shm_id, IPC_RMID, NULL);
+        host_shm_id = -1;
+        return NULL;
+    }
+    host->pid = pid;
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Coroutine host started with pid %d\n", pid);
+    return host;
+}
+
+/*
+ * Queues a job on the host, returns the host's pid.
+ */
+pid_t host_assign(process_host_t* host, int id, int runtime, int channel)
+{
+    if (host == NULL) return -1;
+
+    // Only the generator moves head
+    unsigned int head = host->head;
+    // Wait for the host to drain the ring if it is full
+    while (head - __atomic_load_n(&host->tail, __ATOMIC_ACQUIRE) == HOST_RING_SIZE)
+        usleep(100);
+
+    host_job_t* job = &host->ring[head % HOST_RING_SIZE];
+    job->id = id;
+    job->runtime = runtime;
+    job->channel = channel;
+    __atomic_store_n(&host->head, head + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&host->bell, 1, __ATOMIC_RELEASE);
+    futex_wake_all(&host->bell);
+    return host->pid;
+}
+
+/*
+ * Tells the host that no more jobs are coming, it exits once the last one
+ * finishes, and removes the ring's shared memory.
+ */
+void destroy_process_host(process_host_t* host)
+{
+    if (host == NULL) return;
+
+    __atomic_store_n(&host->done, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&host->bell, 1, __ATOMIC_RELEASE);
+    futex_wake_all(&host->bell);
+    shmdt(host);
+    // The segment is only destroyed after the host detaches
+    shmctl(host_shm_id, IPC_RMID, NULL);
+    host_shm_id = -1;
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Coroutine host released\n");
+}
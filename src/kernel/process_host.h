@@ -0,0 +1,34 @@
+#pragma once
+
+#include <sys/types.h>
+
+#define HOST_SHM_KEY 600
+#define HOST_RING_SIZE 4096
+
+// A job handed from the generator to the coroutine host
+typedef struct
+{
+    int id;
+    int runtime;
+    int channel; // Command channel the scheduler drives the job through
+} host_job_t;
+
+/*
+ * Single-producer/single-consumer ring of arrivals, the generator writes
+ * at head and the host reads at tail. Each side publishes its index with a
+ * release store and reads the other's with an acquire load, so a job's
+ * fields are visible before the head that covers them.
+ */
+typedef struct
+{
+    pid_t pid; // Host process ID, used as the pid of every job it runs
+    unsigned int head;
+    unsigned int tail;
+    int done; // No more jobs will be assigned
+    int bell; // Futex word bumped by every assignment and by done, the idle host sleeps on it
+    host_job_t ring[HOST_RING_SIZE];
+} process_host_t;
+
+process_host_t* create_process_host(pid_t scheduler_pid);
+pid_t host_assign(process_host_t* host, int id, int runtime, int channel);
+void destroy_process_host(process_host_t* host);
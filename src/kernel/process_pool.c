@@ -0,0 +1,125 @@
+#include "process_pool.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/shm.h>
+#include "colors.h"
+#include "logging.h"
+#include "ipc_keys.h"
+
+int pool_shm_id = -1;
+
+/*
+ * Creates the pool control blocks in shared memory and spawns `size` warm
+ * workers. Each worker attaches to its slot and blocks until a job is assigned.
+ */
+process_pool_t* create_process_pool(int size, pid_t scheduler_pid)
+{
+    if (size > MAX_POOL_WORKERS)
+        size = MAX_POOL_WORKERS;
+
+    pool_shm_id = shmget(ipc_key(POOL_SHM_KEY), sizeof(process_pool_t), IPC_CREAT | 0666);
+    if (pool_shm_id == -1)
+    {
+        perror("Error creating process pool shared memory");
+        return NULL;
+    }
+
+    process_pool_t* pool = (process_pool_t*)shmat(pool_shm_id, NULL, 0);
+    if ((void*)pool == (void*)-1)
+    {
+        perror("Error attaching process pool shared memory");
+        shmctl(pool_shm_id, IPC_RMID, NULL);
+        pool_shm_id = -1;
+        return NULL;
+    }
+
+    pool->size = size;
+    for (int i = 0; i < size; i++)
+    {
+        pool->workers[i].pid = -1;
+        pool->workers[i].state = WORKER_IDLE;
+        pool->workers[i].id = -1;
+        pool->workers[i].runtime = 0;
+        pool->workers[i].channel = -1;
+        sem_init(&pool->workers[i].job_ready, 1, 0);
+    }
+
+    char scheduler_pid_str[16];
+    snprintf(scheduler_pid_str, sizeof(scheduler_pid_str), "%d", scheduler_pid);
+
+    for (int i = 0; i < size; i++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            char slot_str[16];
+            snprintf(slot_str, sizeof(slot_str), "%d", i);
+            execl("./process", "process", "-w", slot_str, scheduler_pid_str, (char*)NULL);
+            perror("execl failed");
+            exit(1);
+        }
+        else if (pid > 0)
+        {
+            pool->workers[i].pid = pid;
+        }
+        else
+        {
+            perror("fork failed");
+            pool->size = i;
+            break;
+        }
+    }
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Process pool started with %d workers\n", pool->size);
+    return pool;
+}
+
+/*
+ * Hands a job to an idle worker, returns the worker's pid
+ * or -1 if every worker is busy.
+ */
+pid_t pool_assign(process_pool_t* pool, int id, int runtime, int channel)
+{
+    if (pool == NULL) return -1;
+
+    for (int i = 0; i < pool->size; i++)
+    {
+        pool_worker_t* worker = &pool->workers[i];
+        if (worker->state != WORKER_IDLE || worker->pid == -1) continue;
+
+        worker->id = id;
+        worker->runtime = runtime;
+        worker->channel = channel;
+        worker->state = WORKER_ASSIGNED;
+        sem_post(&worker->job_ready);
+        return worker->pid;
+    }
+    return -1;
+}
+
+/*
+ * Waits for the workers to finish their current jobs, tells them to exit
+ * and removes the pool's shared memory.
+ */
+void destroy_process_pool(process_pool_t* pool)
+{
+    if (pool == NULL) return;
+
+    for (int i = 0; i < pool->size; i++)
+    {
+        pool_worker_t* worker = &pool->workers[i];
+        while (worker->state == WORKER_ASSIGNED)
+            usleep(1000);
+
+        worker->state = WORKER_EXIT;
+        sem_post(&worker->job_ready);
+    }
+
+    shmdt(pool);
+    shmctl(pool_shm_id, IPC_RMID, NULL);
+    pool_shm_id = -1;
+
+    LOG(LOG_SHARED_MEM, LOG_DEBUG, "[PROC_GENERATOR] Process pool destroyed\n");
+}
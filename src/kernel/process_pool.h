@@ -0,0 +1,33 @@
+#pragma once
+
+#include <semaphore.h>
+#include <sys/types.h>
+
+#define POOL_SHM_KEY 500
+#define MAX_POOL_WORKERS 64
+
+// Worker states
+#define WORKER_IDLE 0
+#define WORKER_ASSIGNED 1
+#define WORKER_EXIT 2
+
+// Control block of one warm worker, the worker blocks on job_ready until assigned
+typedef struct
+{
+    pid_t pid; // Worker process ID
+    int state; // WORKER_IDLE, WORKER_ASSIGNED or WORKER_EXIT
+    int id; // Job id currently assigned
+    int runtime; // Job runtime currently assigned
+    int channel; // Command channel of the job currently assigned
+    sem_t job_ready; // Posted by the generator when a job (or exit) is assigned
+} pool_worker_t;
+
+typedef struct
+{
+    int size;
+    pool_worker_t workers[MAX_POOL_WORKERS];
+} process_pool_t;
+
+process_pool_t* create_process_pool(int size, pid_t scheduler_pid);
+pid_t pool_assign(process_pool_t* pool, int id, int runtime, int channel);
+void destroy_process_pool(process_pool_t* pool);
@@ -0,0 +1,87 @@
+#include "ready_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "headers.h"
+#include "colors.h"
+#include "logging.h"
+
+extern int scheduler_type;
+
+ready_queue_t* create_ready_queue(int capacity)
+{
+    ready_queue_t* queue = (ready_queue_t*)malloc(sizeof(ready_queue_t));
+    if (!queue)
+    {
+        perror("Failed to allocate ready queue");
+        return NULL;
+    }
+    queue->buckets = NULL;
+    queue->heap = (pcb_heap_t){0};
+    queue->capacity = capacity;
+    if (scheduler_type == HPF)
+        queue->buckets = create_bucket_queue();
+    if (!queue->buckets)
+        pcb_heap_init(&queue->heap, capacity);
+    return queue;
+}
+
+// Moves every bucketed PCB to the heap, which keeps their (priority, arrival time) order
+static void switch_to_heap(ready_queue_t* queue)
+{
+    int size = bucket_queue_size(queue->buckets);
+    pcb_heap_init(&queue->heap, size > queue->capacity ? size : queue->capacity);
+
+    PCB* process;
+    while ((process = (PCB*)bucket_queue_extract_min(queue->buckets)) != NULL)
+        pcb_heap_push(&queue->heap, process->priority, process->arrival_time, process);
+    destroy_bucket_queue(queue->buckets);
+    queue->buckets = NULL;
+
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Priority out of the bucket range, ready queue moved to a heap\n");
+}
+
+void ready_queue_insert(ready_queue_t* queue, PCB* process)
+{
+    if (queue->buckets)
+    {
+        if (bucket_queue_insert_ordered(queue->buckets, process->priority, process->arrival_time, process))
+            return;
+        switch_to_heap(queue);
+    }
+    int key = (scheduler_type == HPF) ? process->priority : process->remaining_time;
+    pcb_heap_push(&queue->heap, key, process->arrival_time, process);
+}
+
+PCB* ready_queue_peek(ready_queue_t* queue)
+{
+    if (queue->buckets)
+        return (PCB*)bucket_queue_peek(queue->buckets);
+    pcb_heap_entry_t* min = pcb_heap_peek(&queue->heap);
+    return min ? (PCB*)min->handle : NULL;
+}
+
+PCB* ready_queue_extract(ready_queue_t* queue)
+{
+    if (queue->buckets)
+        return (PCB*)bucket_queue_extract_min(queue->buckets);
+    pcb_heap_entry_t min;
+    return pcb_heap_pop(&queue->heap, &min) ? (PCB*)min.handle : NULL;
+}
+
+int ready_queue_is_empty(ready_queue_t* queue)
+{
+    return queue->buckets ? bucket_queue_is_empty(queue->buckets) : pcb_heap_is_empty(&queue->heap);
+}
+
+int ready_queue_size(ready_queue_t* queue)
+{
+    return queue->buckets ? bucket_queue_size(queue->buckets) : queue->heap.size;
+}
+
+void destroy_ready_queue(ready_queue_t* queue)
+{
+    if (queue->buckets)
+        destroy_bucket_queue(queue->buckets);
+    pcb_heap_destroy(&queue->heap);
+    free(queue);
+}
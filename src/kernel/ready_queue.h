@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pcb.h"
+#include "dary_heap.h"
+#include "bucket_queue.h"
+
+// 4-ary heap of PCB pointers keyed inline, a sibling group is one cache line
+DARY_HEAP_DEFINE(pcb_heap, int, 4)
+
+/*
+ * Ready queue of the HPF and SRTN schedulers. A PCB's key is copied into the
+ * heap when it is inserted (priority for HPF, remaining time for SRTN, arrival
+ * time as the tie break), so the heap never touches the PCBs while sifting.
+ * A PCB must not change its key while it is queued.
+ *
+ * HPF starts on a bucket queue, priorities are small integers in practice and
+ * every operation is then O(1). Each bucket is kept sorted by arrival time,
+ * the heap's tie break, so processes back from I/O or admitted late from the
+ * memory waiting list are picked the same way on either; only processes with
+ * the same priority and arrival time have no defined order. The first priority
+ * outside the bucket range moves the queued PCBs to the heap for the rest of
+ * the run.
+ */
+typedef struct
+{
+    bucket_queue_t* buckets; // NULL once the queue runs on the heap
+    pcb_heap_t heap;
+    int capacity; // Initial heap capacity, the heap is allocated on first use
+} ready_queue_t;
+
+ready_queue_t* create_ready_queue(int capacity);
+void ready_queue_insert(ready_queue_t* queue, PCB* process);
+PCB* ready_queue_peek(ready_queue_t* queue);
+PCB* ready_queue_extract(ready_queue_t* queue);
+int ready_queue_is_empty(ready_queue_t* queue);
+int ready_queue_size(ready_queue_t* queue);
+void destroy_ready_queue(ready_queue_t* queue);
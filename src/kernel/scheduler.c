@@ -1,5 +1,6 @@
 #include "scheduler.h"
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <sys/msg.h>
@@ -8,36 +9,202 @@
 
 #include "clk.h"
 #include "scheduler_utils.h"
-#include "min_heap.h"
-#include "queue.h"
+#include "ready_queue.h"
+#include "deque.h"
 #include <sys/types.h>
 #include <sys/wait.h>
-#include "shared_mem.h"
+#include "command_channel.h"
+#include "ipc_keys.h"
+#include "bench.h"
+#include "latency.h"
+#include "memory_manager.h"
+#include "io_devices.h"
+#include "des_engine.h"
+#include "metrics_page.h"
+#include "arrival_queue.h"
+#include "timing_wheel.h"
+#include "futex.h"
 
 #include "headers.h"
 #include "colors.h"
+#include "logging.h"
 extern int total_busy_time;
-extern finishedProcessInfo** finished_process_info;
 // Use pointers for both possible queue types
-min_heap_t* min_heap_queue = NULL;
-Queue* rr_queue = NULL;
+ready_queue_t* min_heap_queue = NULL;
+Deque* rr_queue = NULL; // Run queue of PCB pointers
 
 extern int msgid;
 extern int scheduler_type;
 extern int quantum;
-extern finishedProcessInfo** finished_process_info;
-extern int finished_processes_count;
-int process_shm_id = -1; // Shared memory ID
+static volatile sig_atomic_t running_exited = 0; // Set by child_cleanup(), the dispatch loop finishes the process
+
+#define EXIT_WAIT_NS 1000000 // Bounds each sleep for a finished process's SIGCHLD, it may land just before the sleep
+#define SLICE_TIMER ((void*)1)
+#define IO_TIMER ((void*)2)
+
+static timing_wheel_t* dispatch_timers = NULL; // Ticks the dispatch loop has to wake up at
+static timing_wheel_node_t* slice_timer = NULL; // End of the running slice, a tick for each SRTN re-check
+static timing_wheel_node_t* io_timer = NULL; // Earliest I/O completion
+static int io_timer_tick = -1;
+static int arrivals_seen = 0; // Arrival bell as receive_processes() last read it
+static int receive_until = INT_MAX; // RR: last tick receive_processes() takes in, the running slice ends after it
+static arrival_t* held_arrival = NULL; // Taken from the intake past receive_until
+
+static void fire_dispatch_timer(void* data, int expires, void* context)
+{
+    (void)expires;
+    (void)context;
+    if (data == SLICE_TIMER)
+        slice_timer = NULL;
+    else
+    {
+        io_timer = NULL;
+        io_timer_tick = -1;
+    }
+}
+
+// Puts the end of the slice just dispatched on the dispatch timers
+static void arm_slice_timer(int expires)
+{
+    if (slice_timer)
+        timing_wheel_cancel(dispatch_timers, slice_timer);
+    slice_timer = timing_wheel_schedule(dispatch_timers, expires, SLICE_TIMER);
+}
+
+static void disarm_slice_timer()
+{
+    if (slice_timer)
+        timing_wheel_cancel(dispatch_timers, slice_timer);
+    slice_timer = NULL;
+}
+
+/*
+ * Sleeps until something the dispatch loop acts on may have happened: the
+ * process on `channel` (-1 for none) acknowledged its command, the intake
+ * thread published an arrival, or the tick of a dispatch timer came. The
+ * clock only wakes it while a timer is pending or the metrics page wants
+ * every tick. SIGCHLD ends the sleep as well, `timeout_ns` (0 for none)
+ * bounds it while one is expected in case it lands just before the sleep.
+ */
+static void await_event(int channel, long timeout_ns)
+{
+    int now = get_clk();
+    timing_wheel_advance(dispatch_timers, now, fire_dispatch_timer, NULL);
+    // One timer follows the earliest I/O completion, devices start and finish requests between sleeps
+    int io_next = io_next_completion();
+    if (io_next != io_timer_tick)
+    {
+        if (io_timer)
+            timing_wheel_cancel(dispatch_timers, io_timer);
+        io_timer = io_next == -1 ? NULL : timing_wheel_schedule(dispatch_timers, io_next, IO_TIMER);
+        io_timer_tick = io_next;
+    }
+    if (io_next != -1 && io_next <= now && io_next <= receive_until)
+        return; // Due already, receive_processes() completes it
+
+    int* words[3];
+    int expected[3];
+    int count = 0;
+    words[count] = arrival_bell();
+    expected[count++] = arrivals_seen;
+    if (channel >= 0)
+    {
+        command_channel_t* entry = &channel_table->channels[channel];
+        int acked = __atomic_load_n(&entry->acked, __ATOMIC_ACQUIRE);
+        if (acked == __atomic_load_n(&entry->doorbell, __ATOMIC_ACQUIRE))
+            return;
+        words[count] = &entry->acked;
+        expected[count++] = acked;
+    }
+    if (!timing_wheel_is_empty(dispatch_timers) || metrics_page)
+    {
+        words[count] = clk_word();
+        expected[count++] = now;
+    }
+    futex_wait_any(words, expected, count, timeout_ns);
+}
+
+// Waits for the process on `channel` to acknowledge, returns whether processes arrived or came back meanwhile
+static int await_ack(int channel)
+{
+    int received = 0;
+    while (channel_busy(channel_table, channel))
+    {
+        if (receive_processes() == 0)
+            received = 1;
+        await_event(channel, 0);
+    }
+    disarm_slice_timer();
+    return received;
+}
+
+// Retires the running process once it exited, on the dispatch thread so nothing here runs in a signal handler
+static void finish_running_process()
+{
+    int current_time = get_clk();
+    running_exited = 0;
+    running_process->finish_time = current_time;
+    running_process->remaining_time = 0;
+    log_process_state(running_process, "finished", current_time);
+    record_finished_process(running_process, current_time);
+    memory_release(running_process, current_time);
+    LATENCY_RECORD(LATENCY_EXIT, channel_table->channels[running_process->channel].acked_ns);
+    channel_release(channel_table, running_process->channel);
+    process_count--;
+
+    free(running_process);
+    running_process = NULL;
+}
+
+// Waits for the running process, which acknowledged its last slice, to exit and finishes it
+static void await_exit()
+{
+    while (!running_exited)
+    {
+        receive_processes();
+        await_event(-1, EXIT_WAIT_NS);
+    }
+    finish_running_process();
+}
+
+/*
+ * Takes in every arrival due by the current tick before a decision. The
+ * generator and this loop wake up at a tick in no fixed order, so until the
+ * generator's tick marker covers the tick more of its arrivals may be on the
+ * way. Returns whether processes arrived or came back from I/O.
+ */
+static int receive_tick_arrivals()
+{
+    int received = 0;
+    while (1)
+    {
+        int now = get_clk();
+        // Read before the marker, a marker published after it rings a bell the sleep below sees
+        int bell = __atomic_load_n(arrival_bell(), __ATOMIC_ACQUIRE);
+        // Read before draining, the arrivals the marker covers were published before it
+        int through = arrivals_through();
+        int status = receive_processes();
+        if (status != ENOMSG)
+            received = 1;
+        if (through >= now || status == -2)
+            return received;
+        futex_wait(arrival_bell(), bell, NULL);
+    }
+}
 
 void run_scheduler()
 {
     signal(SIGINT, scheduler_cleanup);
-    signal(SIGCHLD, child_cleanup);
+    // Without SA_RESTART, so the signal ends the sleep in await_exit()
+    struct sigaction exited = {0};
+    exited.sa_handler = child_cleanup;
+    sigemptyset(&exited.sa_mask);
+    sigaction(SIGCHLD, &exited, NULL);
     sync_clk();
 
     if (init_scheduler() == -1)
     {
-        fprintf(stderr, ANSI_COLOR_GREEN"[SCHEDULER] Failed to initialize scheduler\n"ANSI_COLOR_RESET);
+        LOG(LOG_SCHEDULER, LOG_ERROR, "[SCHEDULER] Failed to initialize scheduler\n");
         return;
     }
     int start_process_time = 0;
@@ -47,13 +214,11 @@ void run_scheduler()
         int receive_status = receive_processes();
         if (receive_status == -2 && !process_count)
         {
-            if (DEBUG)
-                printf(
-                    ANSI_COLOR_GREEN"[SCHEDULER] Message queue has been closed. Terminating scheduler.\n"
-                    ANSI_COLOR_RESET);
+            LOG(LOG_SCHEDULER, LOG_INFO, "[SCHEDULER] Message queue has been closed. Terminating scheduler.\n");
             break; // Exit the scheduling loop
         }
-        receive_processes();
+        // Decide only once every arrival of this tick is in, as the des engine does
+        receive_tick_arrivals();
 
 
         if (scheduler_type == HPF) // HPF
@@ -61,96 +226,114 @@ void run_scheduler()
             start_process_time = get_clk();
             int crt_clk = get_clk();
             running_process = hpf(min_heap_queue, crt_clk);
-            if (running_process == NULL) continue; // there is no process to run
+            if (running_process == NULL)
+            {
+                // Nothing to run, sleep until something arrives or comes back from I/O
+                await_event(-1, 0);
+                continue;
+            }
             start_process_time = get_clk();
-            int time_slice = running_process->remaining_time;
+            io_cpu_busy(1, start_process_time);
+            int time_slice = cpu_burst_left(running_process);
+            int channel = running_process->channel;
 
-            // Write current clock as handshake
-            write_process_info(process_shm_id, running_process->pid, time_slice, 1, crt_clk);
+            // Ring the process with the current clock as handshake
+            channel_run(channel_table, channel, time_slice, crt_clk);
+            arm_slice_timer(crt_clk + time_slice);
 
-            running_process->remaining_time = 0;
-            pid_t p_pid = running_process->pid;
-            process_info_t process_info;
+            running_process->remaining_time -= time_slice;
+            running_process->burst_ran += time_slice;
 
-            if (DEBUG)
-                printf(ANSI_COLOR_GREEN"[SCHEDULER] RUNNING PID %d for %d units\n"ANSI_COLOR_RESET,
-                       running_process->pid, time_slice);
-            kill(running_process->pid, SIGCONT);
+            LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] RUNNING PID %d for %d units\n", running_process->pid,
+                time_slice);
 
-            while ((process_info = read_process_info(process_shm_id, p_pid)).status)
-            {
-                receive_processes();
-            }
+            await_ack(channel);
+            // The tick's arrivals come before the slice end, so they get memory before the process frees its own
+            receive_tick_arrivals();
 
-            // Wait until the process is cleanedup
-            while (running_process != NULL)
+            // A finished CPU burst with runtime left goes to its device
+            if (running_process && io_burst_done(running_process))
             {
-                receive_processes();
+                channel_stop(channel_table, channel);
+                io_block(running_process, get_clk());
+                running_process = NULL;
             }
+
+            // Wait until the process is cleanedup, unless it went to its device
+            if (running_process != NULL)
+                await_exit();
             end_process_time = get_clk();
+            io_cpu_busy(0, end_process_time);
             total_busy_time += (end_process_time - start_process_time);
         }
 
         else if (scheduler_type == SRTN)
         {
             start_process_time = get_clk();
-            running_process = srtn(min_heap_queue);
-            if (running_process == NULL) continue; // there is no process to run
+            running_process = srtn(min_heap_queue, get_clk());
+            if (running_process == NULL)
+            {
+                // Nothing to run, sleep until something arrives or comes back from I/O
+                await_event(-1, 0);
+                continue;
+            }
+            io_cpu_busy(1, start_process_time);
 
             pid_t p_pid = running_process->pid;
+            int channel = running_process->channel;
             int remaining_time = running_process->remaining_time;
             int ran = 0;
             int preempt = 0;
+            int blocked = 0; // The CPU burst ended, the process goes to its device
             int crt_clk = get_clk();
 
-            write_process_info(process_shm_id, p_pid, 1, 1, crt_clk);
-            if (DEBUG)
-                printf(ANSI_COLOR_GREEN"[SCHEDULER] RUNNING PID %d for SRTN scheduling\n"ANSI_COLOR_RESET,
-                       running_process->pid);
-            kill(running_process->pid, SIGCONT);
+            channel_run(channel_table, channel, 1, crt_clk);
+            arm_slice_timer(crt_clk + 1);
+            LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] RUNNING PID %d for SRTN scheduling\n", running_process->pid);
 
             // While the process has more time to run
             while (ran < remaining_time)
             {
-                // Wait until the process finishes the time slice and during that check if any new process arrives
-                while (read_process_info(process_shm_id, p_pid).status != 0)
+                // Wait until the process finishes the time unit and every arrival of the tick is in, the
+                // ready queue only grows meanwhile so checking its shortest once covers every arrival
+                int received = await_ack(channel);
+                if (receive_tick_arrivals())
+                    received = 1;
+                if (received && !ready_queue_is_empty(min_heap_queue))
                 {
-                    // Check if there are any newly arrived processes
-                    // If we received new processes and the min heap is not empty, check for preemption
-                    if (receive_processes() == 0 && !min_heap_is_empty(min_heap_queue))
-                    {
-                        PCB* shortest = (PCB*)min_heap_get_min(min_heap_queue);
-                        if (shortest && shortest->remaining_time < remaining_time - ran)
-                            // Preempt the current process
-                            preempt = 1;
-                    }
+                    PCB* shortest = ready_queue_peek(min_heap_queue);
+                    if (shortest && shortest->remaining_time < remaining_time - ran)
+                        // Preempt the current process
+                        preempt = 1;
                 }
 
                 ran++;
 
                 if (running_process)
                 {
+                    running_process->burst_ran++;
                     // Process has more time to run
                     if (ran < remaining_time)
                     {
-                        // If the process needs to be prempted then break
-                        if (preempt) break;
+                        running_process->remaining_time = remaining_time - ran;
+                        blocked = io_burst_done(running_process);
+                        // If the process needs to be prempted or blocks then break
+                        if (preempt || blocked) break;
 
                         // else
                         // Instruct process to run for another time unit
-                        write_process_info(process_shm_id, running_process->pid, 1, 1, get_clk());
-                        if (DEBUG)
-                            printf(
-                                ANSI_COLOR_GREEN"[SCHEDULER] PID %d continued for another unit. %d/%d completed\n"
-                                ANSI_COLOR_RESET,
-                                running_process->pid, ran, running_process->remaining_time);
+                        int next_unit = get_clk();
+                        channel_run(channel_table, channel, 1, next_unit);
+                        arm_slice_timer(next_unit + 1);
+                        LOG(LOG_SCHEDULER, LOG_DEBUG,
+                            "[SCHEDULER] PID %d continued for another unit. %d/%d completed\n", running_process->pid,
+                            ran, running_process->remaining_time);
                     }
                     else
                     {
                         // Process completed its current time slice
-                        if (DEBUG)
-                            printf(ANSI_COLOR_GREEN"[SCHEDULER] PID %d completed time slice\n"ANSI_COLOR_RESET,
-                                   running_process->pid);
+                        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d completed time slice\n",
+                            running_process->pid);
                         break;
                     }
                 }
@@ -160,48 +343,43 @@ void run_scheduler()
             if ((remaining_time - ran) <= 0)
             {
                 // Wait for the process to be cleaned up
-                while (running_process != NULL)
-                {
-                    receive_processes();
-                }
-                printf(ANSI_COLOR_GREEN"[SCHEDULER] PID %d has completed execution\n"ANSI_COLOR_RESET, p_pid);
+                await_exit();
+                LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d has completed execution\n", p_pid);
             }
 
-            // handle preempting and process still exists and there is still time left
-            if (running_process && preempt)
+            // handle preempting or blocking and process still exists and there is still time left
+            if (running_process && (preempt || blocked))
             {
                 if ((remaining_time - ran) > 0)
                 {
                     // Update remaining time and reinsert into min heap
-                    running_process->remaining_time -= ran;
-                    running_process->last_run_time = get_clk();
-                    running_process->status = READY;
-
-                    log_process_state(running_process, "stopped", get_clk()); // Add explicit preemption log
-
-                    // Update process status to paused
-                    write_process_info(process_shm_id, running_process->pid, 0, 0, crt_clk);
-                    kill(running_process->pid, SIGTSTP); // Stop the process
+                    running_process->remaining_time = remaining_time - ran;
+                    if (!blocked)
+                    {
+                        running_process->last_run_time = get_clk();
+                        running_process->status = READY;
+                        log_process_state(running_process, "stopped", get_clk()); // Add explicit preemption log
+                    }
 
                     int crt_time = get_clk();
-                    // Wait gracefully until the process reports that it stopped
-                    while (get_clk() - crt_time < 10 && read_process_info(process_shm_id, running_process->pid).status)
+                    // Stop the process, it acknowledges once it is idle
+                    channel_stop(channel_table, channel);
+                    if (blocked)
+                        io_block(running_process, crt_time);
+                    else
                     {
-                        receive_processes();
+                        LOG(LOG_SCHEDULER, LOG_DEBUG,
+                            "[SCHEDULER] PID %d preempted and reinserted into queue with %d units remaining\n", p_pid,
+                            running_process->remaining_time);
+
+                        // Reinsert the process into the min heap
+                        ready_queue_insert(min_heap_queue, running_process);
                     }
-                    if (DEBUG)
-                        printf(
-                            ANSI_COLOR_GREEN
-                            "[SCHEDULER] PID %d preempted and reinserted into queue with %d units remaining\n"
-                            ANSI_COLOR_RESET,
-                            p_pid, running_process->remaining_time);
-
-                    // Reinsert the process into the min heap
-                    min_heap_insert(min_heap_queue, running_process);
                     running_process = NULL;
                 }
             }
             end_process_time = get_clk();
+            io_cpu_busy(0, end_process_time);
             total_busy_time += (end_process_time - start_process_time);
         }
         else if (scheduler_type == RR)
@@ -209,146 +387,163 @@ void run_scheduler()
             start_process_time = get_clk();
             int crt_clk = get_clk();
             running_process = rr(rr_queue, crt_clk);
-            if (running_process == NULL) continue; // there is no process to run
+            if (running_process == NULL)
+            {
+                // Nothing to run, sleep until something arrives or comes back from I/O
+                await_event(-1, 0);
+                continue;
+            }
+            io_cpu_busy(1, start_process_time);
 
             int remaining_time = running_process->remaining_time;
-            int time_slice = (remaining_time < quantum) ? remaining_time : quantum;
+            int burst = cpu_burst_left(running_process);
+            int time_slice = (burst < quantum) ? burst : quantum;
             pid_t p_pid = running_process->pid;
+            int channel = running_process->channel;
 
-            // Write current clock as handshake
-            write_process_info(process_shm_id, running_process->pid, time_slice, 1, crt_clk);
+            // Ring the process with the current clock as handshake
+            channel_run(channel_table, channel, time_slice, crt_clk);
+            arm_slice_timer(crt_clk + time_slice);
 
-            if (DEBUG)
-                printf(ANSI_COLOR_GREEN"[SCHEDULER] Running PID %d for %d units (RR)\n"ANSI_COLOR_RESET,
-                       running_process->pid, time_slice);
+            LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Running PID %d for %d units (RR)\n", running_process->pid,
+                time_slice);
 
-            // Continue the process
-            kill(running_process->pid, SIGCONT);
-
-            // Wait for the process to finish its time slice
-            while (read_process_info(process_shm_id, p_pid).status)
-            {
-                receive_processes(); // Check for new arrivals while waiting
-            }
+            // Wait for the process to finish its time slice, taking arrivals meanwhile. The expired process
+            // goes back to the queue before the arrivals and I/O completions of the tick its slice ends at
+            receive_until = crt_clk + time_slice - 1;
+            await_ack(channel);
 
             if (running_process != NULL)
             {
                 // Update process accounting
                 remaining_time -= time_slice;
+                running_process->remaining_time = remaining_time;
+                running_process->burst_ran += time_slice;
                 running_process->last_run_time = get_clk();
 
-                if (DEBUG)
-                    printf(
-                        ANSI_COLOR_GREEN"[SCHEDULER] PID %d finished time slice. Remaining time: %d\n"ANSI_COLOR_RESET,
-                        running_process->pid, remaining_time);
+                LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d finished time slice. Remaining time: %d\n",
+                    running_process->pid, remaining_time);
 
                 if (remaining_time <= 0)
                 {
                     // Wait for the process to be cleaned up
-                    while (running_process != NULL)
-                    {
-                        receive_processes();
-                    }
+                    await_exit();
 
-                    printf(ANSI_COLOR_GREEN"[SCHEDULER] PID %d has completed execution\n"ANSI_COLOR_RESET, p_pid);
+                    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d has completed execution\n", p_pid);
+                }
+                else if (io_burst_done(running_process))
+                {
+                    // The CPU burst is over, the process waits for its device
+                    channel_stop(channel_table, channel);
+                    io_block(running_process, running_process->last_run_time);
+                    running_process = NULL;
                 }
                 else
                 {
                     // Process still has time remaining, put it back in the queue
                     running_process->status = READY;
-                    running_process->remaining_time = remaining_time;
 
                     log_process_state(running_process, "stopped", get_clk());
-                    kill(p_pid, SIGTSTP);
+                    channel_stop(channel_table, channel);
 
-                    enqueue(rr_queue, running_process);
+                    pushBack(rr_queue, &running_process);
                     running_process = NULL;
 
-                    if (DEBUG)
-                        printf(
-                            ANSI_COLOR_GREEN"[SCHEDULER] PID %d re-enqueued with %d units remaining\n"ANSI_COLOR_RESET,
-                            p_pid, remaining_time);
+                    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d re-enqueued with %d units remaining\n", p_pid,
+                        remaining_time);
                 }
             }
-            else if (DEBUG)
-            {
-                printf(ANSI_COLOR_GREEN"[SCHEDULER] PID %d has completed execution\n"ANSI_COLOR_RESET, p_pid);
-            }
+            else
+                LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] PID %d has completed execution\n", p_pid);
+            receive_until = INT_MAX;
             end_process_time = get_clk();
+            io_cpu_busy(0, end_process_time);
             total_busy_time += (end_process_time - start_process_time);
         }
     }
 
+    stop_arrival_intake();
+    destroy_timing_wheel(dispatch_timers);
+    dispatch_timers = NULL;
     // Must Be called before the clock is destroyed !!!
-    generate_statistics();
+    generate_statistics(get_clk());
+    write_bench_report(get_clk());
+    write_latency_report();
     destroy_clk(1);
     exit(0);
 }
 
-int receive_processes(void)
+static void enqueue_ready(PCB* process)
 {
-    if (msgid == -1)
-        return -1;
+    if (scheduler_type == HPF || scheduler_type == SRTN)
+        ready_queue_insert(min_heap_queue, process);
+    else if (scheduler_type == RR)
+        pushBack(rr_queue, &process);
+}
 
-    PCB received_pcb;
-    size_t recv_val = msgrcv(msgid, &received_pcb, sizeof(PCB), 1, IPC_NOWAIT);
+static int ready_depth()
+{
+    if (min_heap_queue)
+        return ready_queue_size(min_heap_queue);
+    return rr_queue ? (int)rr_queue->size : 0;
+}
 
-    if (recv_val == -1)
+int receive_processes(void)
+{
+    metrics_tick(get_clk(), ready_depth(), process_count, total_busy_time);
+
+    // Processes back from I/O count as received, so SRTN considers preempting for them too
+    int now = get_clk();
+    int returned = io_complete(now < receive_until ? now : receive_until, enqueue_ready);
+
+    // Read before draining, an arrival published after it rings a bell await_event() does not sleep on
+    arrivals_seen = __atomic_load_n(arrival_bell(), __ATOMIC_ACQUIRE);
+    // Read before draining, once it is set every arrival is already in the intake queue
+    int closed = arrivals_closed();
+    // Read before draining as well, every arrival up to it is already in the intake queue
+    int through = arrivals_through();
+    int received = 0;
+    arrival_t* arrival;
+    while ((arrival = held_arrival ? held_arrival : take_arrival()) != NULL)
     {
-        if (errno == ENOMSG)
-            return errno; // No message available
-        else if (errno == EIDRM || errno == EINVAL)
-        {
-            // EIDRM: Queue was removed
-            // EINVAL: Invalid queue ID (queue no longer exists)
-            // printf("[SCHEDULER] Message queue has been closed or removed\n");
-            return -2; // Special return value to indicate queue closure
-        }
-        else
+        held_arrival = NULL;
+        if (arrival->pcb.arrival_time > receive_until)
         {
-            perror("Error receiving message");
-            return errno;
+            // Arrivals come in arrival order, every later one waits behind it
+            held_arrival = arrival;
+            break;
         }
-    }
-
-    while (recv_val != -1)
-    {
-        printf(
-            ANSI_COLOR_GREEN"[SCHEDULER] Received process ID: %d, arrival time: %d, remaining_time: %d at %d\n"
-            ANSI_COLOR_RESET,
-            received_pcb.pid, received_pcb.arrival_time, received_pcb.remaining_time, get_clk());
-
         PCB* new_pcb = (PCB*)malloc(sizeof(PCB));
         if (!new_pcb)
         {
             perror("Failed to allocate memory for PCB");
-            break;
+            free(arrival);
+            continue;
         }
-        *new_pcb = received_pcb; // shallow copy, doesnt matter
+        *new_pcb = arrival->pcb; // shallow copy, doesnt matter
+        free(arrival);
 
-        if (scheduler_type == HPF || scheduler_type == SRTN)
-            min_heap_insert(min_heap_queue, new_pcb);
-        else if (scheduler_type == RR)
-            enqueue(rr_queue, new_pcb);
+        // Processes that do not fit in memory yet wait outside the ready queue
+        if (memory_admit(new_pcb, get_clk()))
+            enqueue_ready(new_pcb);
+        BENCH_STOP(BENCH_ENQUEUE, new_pcb->sent_ns);
 
         process_count++;
-        recv_val = msgrcv(msgid, &received_pcb, sizeof(PCB), 1, IPC_NOWAIT);
-
-        if (recv_val == -1 && (errno == EIDRM || errno == EINVAL))
-        {
-            if (DEBUG)
-                printf("[SCHEDULER] Message queue has been closed or removed during processing\n");
-            return -2; // Queue was removed during processing
-        }
+        received++;
     }
-
-    return 0;
+    // Memory freed by finished processes may let waiting processes in, once every process of the tick is in as the
+    // des engine does at the end of a tick
+    if ((closed || through >= now) && !held_arrival)
+        memory_admit_waiting(now, enqueue_ready);
+
+    if (closed)
+        return -2; // Special return value to indicate queue closure
+    return received || returned ? 0 : ENOMSG;
 }
 
 void scheduler_cleanup(int signum)
 {
-    if (DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] scheduler_cleanup CALLED\n"ANSI_COLOR_RESET);
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] scheduler_cleanup CALLED\n");
 
     if (log_file)
     {
@@ -356,33 +551,28 @@ void scheduler_cleanup(int signum)
         log_file = NULL;
     }
 
-    // Clean up shared memory
-    cleanup_shared_memory(process_shm_id);
-    process_shm_id = -1;
+    // Tell processes still waiting to exit and remove the channels
+    destroy_channel_table(channel_table);
+    channel_table = NULL;
 
     // Cleanup memory resources if they still exist
     if (min_heap_queue)
     {
         // Free any remaining PCBs in the heap
-        while (min_heap_queue->size > 0)
-        {
-            PCB* pcb = min_heap_extract_min(min_heap_queue);
-            if (pcb)
-                free(pcb);
-        }
-        free(min_heap_queue);
+        PCB* pcb;
+        while ((pcb = ready_queue_extract(min_heap_queue)) != NULL)
+            free(pcb);
+        destroy_ready_queue(min_heap_queue);
         min_heap_queue = NULL;
     }
 
     if (rr_queue)
     {
         // Free any remaining PCBs in the queue
-        while (!isQueueEmpty(rr_queue))
-        {
-            PCB* pcb = dequeue(rr_queue);
-            if (pcb)
-                free(pcb);
-        }
+        PCB* pcb;
+        while (popFront(rr_queue, &pcb))
+            free(pcb);
+        clearDeque(rr_queue);
         free(rr_queue);
         rr_queue = NULL;
     }
@@ -399,21 +589,17 @@ void scheduler_cleanup(int signum)
         msgid = -1;
     }
 
-    for (int i = 0; i < MAX_INPUT_PROCESSES; i++)
-        if (finished_process_info[i] != NULL)
-        {
-            free(finished_process_info[i]);
-            finished_process_info[i] = NULL;
-        }
-
-    if (finished_process_info != NULL)
+    if (dispatch_timers)
     {
-        free(finished_process_info);
-        finished_process_info = NULL;
+        destroy_timing_wheel(dispatch_timers);
+        dispatch_timers = NULL;
     }
+    free_finished_processes();
+    cleanup_memory();
+    cleanup_io();
+    destroy_metrics_page();
 
-    if (DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] scheduler_cleanup FINISHED \n"ANSI_COLOR_RESET);
+    LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] scheduler_cleanup FINISHED \n");
 
     // if (signum != 0)
     // {
@@ -423,59 +609,16 @@ void scheduler_cleanup(int signum)
 
 void child_cleanup()
 {
-    if (running_process == NULL) return;;
-
-    // sync_clk();
-    signal(SIGCHLD, child_cleanup);
-    if (DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] CHILD_CLEANUP CALLED\n"ANSI_COLOR_RESET);
-
-    if (running_process)
-    {
-        int current_time = get_clk();
-        running_process->finish_time = current_time;
-        running_process->remaining_time = 0;
-        log_process_state(running_process, "finished", current_time);
-        if (finished_processes_count < MAX_INPUT_PROCESSES)
-        {
-            if (finished_process_info[finished_processes_count] == NULL)
-            {
-                finished_process_info[finished_processes_count] = (finishedProcessInfo*)malloc(
-                    sizeof(finishedProcessInfo));
-                if (!finished_process_info[finished_processes_count])
-                {
-                    perror("Failed to malloc finished_process_info");
-                }
-                else
-                {
-                    // Only access if malloc succeeded
-                    finished_process_info[finished_processes_count]->ta = current_time - running_process
-                        ->arrival_time;
-                    finished_process_info[finished_processes_count]->wta =
-                        (running_process->runtime > 0)
-                            ? ((float)(finished_process_info[finished_processes_count]->ta) / running_process->runtime)
-                            : 0.0;
-                    finished_process_info[finished_processes_count]->waiting_time = running_process->waiting_time;
-                }
-            }
-
-            process_count--;
-            finished_processes_count++;
-        }
-        else
-        {
-            printf(ANSI_COLOR_GREEN"[SCHEDULER] WARNING: Exceeded maximum number of processes!\n"ANSI_COLOR_RESET);
-        }
-
-        free(running_process);
-        running_process = NULL;
-    }
-    else
-    {
-        printf("[SCHEDULER] Requested to cleanup none????\n");
-    }
-    if (DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] CHILD_CLEANUP FINISHED\n"ANSI_COLOR_RESET);
+    /*
+     * Only the running process can be finishing, and it marks its channel
+     * CHANNEL_DONE before its last acknowledgement. A SIGCHLD from anything
+     * else (a process that already finished, the clock) leaves the flag alone
+     * so await_exit() does not finish the running process early.
+     */
+    PCB* running = running_process;
+    if (running && channel_table &&
+        __atomic_load_n(&channel_table->channels[running->channel].state, __ATOMIC_ACQUIRE) == CHANNEL_DONE)
+        running_exited = 1;
 }
 
 int init_scheduler()
@@ -483,18 +626,11 @@ int init_scheduler()
     int current_time = get_clk();
     process_count = 0;
     running_process = NULL;
-
-    // Initialize shared memory
-    process_shm_id = create_shared_memory(SHM_KEY);
-    if (process_shm_id == -1)
-    {
-        perror("Failed to create shared memory");
-        return -1;
-    }
+    running_exited = 0;
 
     if (scheduler_type == HPF || scheduler_type == SRTN)
     {
-        min_heap_queue = create_min_heap(MAX_INPUT_PROCESSES, compare_processes);
+        min_heap_queue = create_ready_queue(MAX_INPUT_PROCESSES);
         if (min_heap_queue == NULL)
         {
             perror("Failed to create min_heap_queue");
@@ -503,47 +639,35 @@ int init_scheduler()
     }
     else if (scheduler_type == RR)
     {
-        rr_queue = (Queue*)malloc(sizeof(Queue));
+        rr_queue = (Deque*)malloc(sizeof(Deque));
         if (rr_queue == NULL)
         {
             perror("Failed to allocate memory for rr_queue");
             return -1;
         }
-        initQueue(rr_queue, sizeof(PCB));
+        initDeque(rr_queue, sizeof(PCB*));
     }
 
+    dispatch_timers = create_timing_wheel(current_time);
+    if (dispatch_timers == NULL)
+        return -1;
+
     // Init IPC
-    key_t key = ftok("process_generator", 65);
-    msgid = msgget(key, 0666 | IPC_CREAT);
+    msgid = msgget(ipc_key(MSG_QUEUE_KEY), 0666 | IPC_CREAT);
     if (msgid == -1)
     {
         perror("Error getting message queue");
         return -1;
     }
-
-    log_file = fopen("scheduler.log", "w");
-    if (log_file == NULL)
-    {
-        perror("Failed to open log file");
+    // Arrivals are read on their own thread, the scheduling loops only pop what it published
+    if (start_arrival_intake(msgid) == -1)
         return -1;
-    }
-    fprintf(log_file, "#At\ttime\tx\tprocess\ty\tstate\tarr\tw\ttotal\tz\tremain\ty\twait\tk\n");
 
-    finished_processes_count = 0;
-    finished_process_info = (finishedProcessInfo**)malloc(MAX_INPUT_PROCESSES * sizeof(finishedProcessInfo*));
-
-    if (!finished_process_info)
-    {
-        perror("Failed to allocate memory for PCB");
+    if (open_scheduler_log() == -1)
         return -1;
-    }
-
-    // Initialize all pointers to NULL
-    for (int i = 0; i < MAX_INPUT_PROCESSES; i++)
-        finished_process_info[i] = NULL;
+    // Optional, the run goes on unpublished without it
+    create_metrics_page(ENGINE_PROCESSES);
 
-    if (DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] Scheduler initialized successfully at time %d\n"ANSI_COLOR_RESET,
-               current_time);
+    LOG(LOG_SCHEDULER, LOG_INFO, "[SCHEDULER] Scheduler initialized successfully at time %d\n", current_time);
     return 0;
 }
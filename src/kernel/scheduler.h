@@ -7,8 +7,7 @@
 void scheduler_cleanup(int signum);
 void run_scheduler();
 int init_scheduler();
-void generate_statistics();
-int compare_processes(const void* a, const void* b);
+void generate_statistics(int total_execution_time);
 void log_process_state(PCB* process, char* state, int time);
 int receive_processes(void);
 void child_cleanup();
@@ -11,5 +11,7 @@ min_heap_t* ready_queue = NULL;
 FILE* log_file = NULL;
 finishedProcessInfo** finished_process_info;
 int finished_processes_count;
+int finished_process_capacity = 0;
+int flush_log_lines = 1; // Flush scheduler.log after every line
 int cpu_idle_time = 0;
 int total_busy_time = 0;
\ No newline at end of file
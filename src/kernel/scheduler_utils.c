@@ -5,71 +5,63 @@
 #include <bits/signum-arch.h>
 #include "clk.h"
 #include "pcb.h"
-#include "queue.h"
+#include "deque.h"
 #include "scheduler.h"
 #include "headers.h"
-#include "min_heap.h"
+#include "ready_queue.h"
 #include "process_generator.h"
 #include "colors.h"
-#include "shared_mem.h"
+#include "logging.h"
+#include "bench.h"
+#include "memory_manager.h"
+#include "paging.h"
+#include "io_devices.h"
+#include "host_engine.h"
+#include "metrics_page.h"
+#include "text_format.h"
 extern int total_busy_time;
 extern int scheduler_type;
 extern finishedProcessInfo** finished_process_info;
 extern int finished_processes_count;
+extern int finished_process_capacity;
+extern int flush_log_lines;
 
-// compare function for priority queue
-int compare_processes(const void* p1, const void* p2)
-{
-    PCB* process1 = (PCB*)p1;
-    PCB* process2 = (PCB*)p2;
-    if (scheduler_type == HPF)
-    {
-        if (process1->priority != process2->priority)
-        {
-            return process1->priority - process2->priority;
-        }
-
-        // If priorities are equal return that come first
-        return process1->arrival_time - process2->arrival_time;
-    }
-    else // SRTN
-    {
-        if (process1->remaining_time != process2->remaining_time)
-        {
-            return process1->remaining_time - process2->remaining_time;
-        }
-
-        // If priorities are equal return that come first
-        return process1->arrival_time - process2->arrival_time;
-    }
-}
+#define LOG_BUFFER_BYTES (1 << 20)
 
 // HPF algorithm
-PCB* hpf(min_heap_t* ready_queue, int current_time)
+PCB* hpf(ready_queue_t* ready_queue, int current_time)
 {
-    if (!min_heap_is_empty(ready_queue))
+    BENCH_START(decision_start);
+    PCB* next_process = ready_queue_extract(ready_queue);
+    if (next_process)
     {
-        PCB* next_process = min_heap_extract_min(ready_queue);
         next_process->status = RUNNING;
-        next_process->waiting_time = current_time - next_process->arrival_time;
+        // Only a process back from I/O runs again
+        if (next_process->last_run_time == -1)
+            next_process->waiting_time = current_time - next_process->arrival_time;
+        else
+            next_process->waiting_time += current_time - next_process->last_run_time;
         // assuming that any process is initially having start time -1
         if (next_process->start_time == -1)
         {
             next_process->start_time = current_time;
+            next_process->response_time = current_time - next_process->arrival_time;
+            log_process_state(next_process, "started", current_time);
         }
-        log_process_state(next_process, "started", current_time);
-        kill(next_process->pid,SIGCONT);
+        else
+            log_process_state(next_process, "resumed", current_time);
+        BENCH_STOP(BENCH_DECISION, decision_start);
         return next_process;
     }
     return NULL;
 }
 
-PCB* srtn(min_heap_t* ready_queue)
+PCB* srtn(ready_queue_t* ready_queue, int current_time)
 {
-    int current_time = get_clk();
-    if (!min_heap_is_empty(ready_queue))
+    BENCH_START(decision_start);
+    PCB* next_process = ready_queue_extract(ready_queue);
+    if (next_process)
     {
-        PCB* next_process = min_heap_extract_min(ready_queue);
         next_process->status = RUNNING;
         if (next_process->last_run_time == -1)
         {
@@ -86,6 +78,7 @@ PCB* srtn(min_heap_t* ready_queue)
         }
         else
             log_process_state(next_process, "resumed", current_time);
+        BENCH_STOP(BENCH_DECISION, decision_start);
         return next_process;
     }
     return NULL;
@@ -93,14 +86,17 @@ PCB* srtn(min_heap_t* ready_queue)
 
 
 // RR algorithm
-PCB* rr(Queue* ready_queue, int current_time)
+PCB* rr(Deque* ready_queue, int current_time)
 {
-    if (!isQueueEmpty(ready_queue))
+    BENCH_START(decision_start);
+    PCB* next_process;
+    if (popFront(ready_queue, &next_process))
     {
-        PCB* next_process = dequeue(ready_queue);
         next_process->status = RUNNING;
-        next_process->waiting_time = (current_time - next_process->arrival_time) - (next_process->runtime - next_process
-            ->remaining_time);
+        if (next_process->last_run_time == -1)
+            next_process->waiting_time = current_time - next_process->arrival_time;
+        else
+            next_process->waiting_time += current_time - next_process->last_run_time;
         if (next_process->start_time == -1)
         {
             next_process->start_time = current_time;
@@ -112,112 +108,186 @@ PCB* rr(Queue* ready_queue, int current_time)
             log_process_state(next_process, "resumed", current_time);
         }
 
+        BENCH_STOP(BENCH_DECISION, decision_start);
         return next_process;
     }
     return NULL;
 }
 
+int open_scheduler_log()
+{
+    log_file = fopen("scheduler.log", "w");
+    if (log_file == NULL)
+    {
+        perror("Failed to open log file");
+        return -1;
+    }
+    // Unflushed logs go out in large writes, setvbuf() must come before the first line
+    if (!flush_log_lines)
+        setvbuf(log_file, NULL, _IOFBF, LOG_BUFFER_BYTES);
+    fprintf(log_file, "#At\ttime\tx\tprocess\ty\tstate\tarr\tw\ttotal\tz\tremain\ty\twait\tk\n");
+    return 0;
+}
+
+// Writes the process's line to scheduler.log, a finished process's with its TA and WTA
+static void write_state_line(PCB* process, const char* state, int time, int finished)
+{
+    char line[192];
+    char* end = format_str(line, "At time ");
+    end = format_int(end, time);
+    end = format_str(end, " process ");
+    end = format_int(end, process->id);
+    *end++ = ' ';
+    end = format_str(end, state);
+    end = format_str(end, " arr ");
+    end = format_int(end, process->arrival_time);
+    end = format_str(end, " total ");
+    end = format_int(end, process->runtime);
+    end = format_str(end, " remain ");
+    end = format_int(end, process->remaining_time);
+    end = format_str(end, " wait ");
+    end = format_int(end, process->waiting_time);
+    if (finished)
+    {
+        end = format_str(end, " TA ");
+        end = format_int(end, time - process->arrival_time); // Turnaround time
+        // Weighted turnaround time, the only field left to snprintf
+        end += snprintf(end, line + sizeof(line) - end, " WTA %.2f",
+                        (process->runtime > 0) ? ((float)(time - process->arrival_time) / process->runtime) : 0.0);
+    }
+    *end++ = '\n';
+    fwrite(line, 1, end - line, log_file);
+}
+
 // Update log_process_state to handle more states
 void log_process_state(PCB* process, char* state, int time)
 {
     if (strcmp(state, "started") == 0)
     {
-        fprintf(log_file, "At time %d process %d %s arr %d total %d remain %d wait %d\n",
-            time, process->id, state, process->arrival_time, process->runtime,
-            process->remaining_time, process->waiting_time);
+        write_state_line(process, state, time, 0);
 
-        if(DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] Process %d started at time %d\n"ANSI_COLOR_RESET,
-               process->pid, time);
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Process %d started at time %d\n", process->pid, time);
+        metrics_dispatch(process->id, process->pid, time);
+        account_enter(&process->account, process->arrival_time, ACCOUNT_RUNNING, time);
     }
     else if (strcmp(state, "finished") == 0)
     {
-        fprintf(log_file, "At time %d process %d %s arr %d total %d remain %d wait %d TA %d WTA %.2f\n",
-                time, process->id, state, process->arrival_time, process->runtime,
-                process->remaining_time, process->waiting_time,
-                (time - process->arrival_time), // Turnaround time
-                (process->runtime > 0) ? ((float)(time - process->arrival_time) / process->runtime) : 0.0); /* Weighted turnaround time */
+        write_state_line(process, state, time, 1);
 
-        if(DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] Process %d finished at time %d\n"ANSI_COLOR_RESET,
-               process->pid, time);
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Process %d finished at time %d\n", process->pid, time);
+        metrics_release();
+        account_enter(&process->account, process->arrival_time, ACCOUNT_FINISHED, time);
     }
     else if (strcmp(state, "resumed") == 0)
     {
-        fprintf(log_file, "At time %d process %d %s arr %d total %d remain %d wait %d\n",
-                time, process->id, state, process->arrival_time, process->runtime,
-                process->remaining_time, process->waiting_time);
+        write_state_line(process, state, time, 0);
+
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Process %d resumed at time %d\n", process->pid, time);
+        metrics_dispatch(process->id, process->pid, time);
+        account_enter(&process->account, process->arrival_time, ACCOUNT_RUNNING, time);
+    }
+    else if (strcmp(state, "stopped") == 0)
+    {
+        write_state_line(process, state, time, 0);
 
-        if(DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] Process %d resumed at time %d\n"ANSI_COLOR_RESET,
-               process->pid, time);
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Process %d stopped at time %d\n", process->pid, time);
+        metrics_release();
+        account_preempt(&process->account, process->arrival_time, time);
     }
-    else if (strcmp(state, "preempted") == 0 || strcmp(state, "blocked") == 0)
+    else if (strcmp(state, "blocked") == 0)
     {
-        fprintf(log_file, "At time %d process %d %s arr %d total %d remain %d wait %d\n",
-                time, process->id, state, process->arrival_time, process->runtime,
-                process->remaining_time, process->waiting_time);
+        write_state_line(process, state, time, 0);
 
-        if(DEBUG)
-        printf(ANSI_COLOR_GREEN"[SCHEDULER] Process %d %s at time %d\n"ANSI_COLOR_RESET,
-               process->pid, state, time);
+        LOG(LOG_SCHEDULER, LOG_DEBUG, "[SCHEDULER] Process %d blocked at time %d\n", process->pid, time);
+        metrics_release();
+        account_enter(&process->account, process->arrival_time, ACCOUNT_BLOCKED, time);
     }
     else
     {
-        fprintf(log_file, "At time %d process %d %s arr %d total %d remain %d wait %d\n",
-                time, process->id, state, process->arrival_time, process->runtime,
-                process->remaining_time, process->waiting_time);
+        LOG(LOG_SCHEDULER, LOG_ERROR, "[SCHEDULER] Process %d logged in unknown state \"%s\" at time %d\n",
+            process->pid, state, time);
+        return;
     }
 
-    fflush(log_file);
+    if (flush_log_lines)
+        fflush(log_file);
 }
 
-void generate_statistics()
+/*
+ * Records the TA/WTA/waiting of a process that finished at `time`,
+ * growing finished_process_info as needed.
+ */
+void record_finished_process(PCB* process, int time)
 {
-    // Return early if no finished processes
-    if (finished_processes_count == 0) return;
+    if (finished_processes_count == finished_process_capacity)
+    {
+        int new_capacity = finished_process_capacity ? finished_process_capacity * 2 : MAX_INPUT_PROCESSES;
+        finishedProcessInfo** grown = (finishedProcessInfo**)realloc(finished_process_info,
+                                                                     new_capacity * sizeof(finishedProcessInfo*));
+        if (!grown)
+        {
+            perror("Failed to grow finished_process_info");
+            return;
+        }
+        for (int i = finished_process_capacity; i < new_capacity; i++)
+            grown[i] = NULL;
+        finished_process_info = grown;
+        finished_process_capacity = new_capacity;
+    }
 
-    // Allocate memory for tracking WTA values
-    float** wta_values = (float**)malloc(finished_processes_count * sizeof(float*));
-    if (!wta_values)
+    finishedProcessInfo* info = (finishedProcessInfo*)malloc(sizeof(finishedProcessInfo));
+    if (!info)
     {
-        perror("Failed to allocate memory for wta_values");
-        return; // Return if allocation fails
+        perror("Failed to malloc finished_process_info");
+        return;
     }
+    info->ta = time - process->arrival_time;
+    info->wta = (process->runtime > 0) ? ((float)(info->ta) / process->runtime) : 0.0;
+    info->waiting_time = process->waiting_time;
+    info->id = process->id;
+    info->arrival_time = process->arrival_time;
+    info->response_time = process->start_time - process->arrival_time;
+    info->account = process->account;
+    metrics_finish(info->wta);
 
-    for (int i = 0; i < finished_processes_count; ++i)
+    finished_process_info[finished_processes_count++] = info;
+}
+
+void free_finished_processes()
+{
+    for (int i = 0; i < finished_processes_count; i++)
     {
-        wta_values[i] = NULL;
+        free(finished_process_info[i]);
+        finished_process_info[i] = NULL;
     }
+    free(finished_process_info);
+    finished_process_info = NULL;
+    finished_process_capacity = 0;
+    finished_processes_count = 0;
+}
+
+void generate_statistics(int total_execution_time)
+{
+    // Return early if no finished processes
+    if (finished_processes_count == 0) return;
 
     float total_wait = 0;
     float total_wta = 0;
     float total_ta = 0;
 
-    int total_execution_time = get_clk(); // Total simulation time
-
     // Loop through all finished processes
     for (int i = 0; i < finished_processes_count; i++)
     {
         // Check if the pointer is valid
         if (finished_process_info[i] == NULL)
         {
-            fprintf(stderr, "[SCHEDULER] Error: finished_process_info[%d] is NULL\n", i);
+            LOG(LOG_SCHEDULER, LOG_ERROR, "[SCHEDULER] Error: finished_process_info[%d] is NULL\n", i);
             continue; // Skip this iteration
         }
 
         total_wait += finished_process_info[i]->waiting_time;
         total_ta += finished_process_info[i]->ta;
         total_wta += finished_process_info[i]->wta;
-
-        // Store WTA values (not waiting times) for standard deviation calculation
-        wta_values[i] = (float*)malloc(sizeof(float));
-        if (!wta_values[i])
-        {
-            fprintf(stderr, "[SCHEDULER] Failed to allocate memory for wta_values[%d]\n", i);
-            continue;
-        }
-        *wta_values[i] = finished_process_info[i]->wta;
     }
 
     float avg_wait = total_wait / finished_processes_count;
@@ -227,10 +297,9 @@ void generate_statistics()
     float sum_squared_diff = 0;
     for (int i = 0; i < finished_processes_count; i++)
     {
-        if (wta_values[i] != NULL)
+        if (finished_process_info[i] != NULL)
         {
-            // Add null check
-            float diff = (*wta_values[i]) - avg_wta;
+            float diff = finished_process_info[i]->wta - avg_wta;
             sum_squared_diff += diff * diff;
         }
     }
@@ -248,21 +317,15 @@ void generate_statistics()
         fprintf(perf_file, "Avg WTA = %.2f\n", avg_wta);
         fprintf(perf_file, "Avg Waiting = %.2f\n", avg_wait);
         fprintf(perf_file, "Std WTA = %.2f\n", std_wta);
+        write_memory_stats(perf_file, total_execution_time);
+        write_vm_stats(perf_file);
+        write_io_stats(perf_file, total_execution_time);
+        write_host_stats(perf_file);
+        write_account_stats(perf_file, total_execution_time);
         fclose(perf_file);
     }
     else
     {
         perror("Failed to open scheduler.perf");
     }
-
-    // Free individual wta_values allocations first
-    for (int i = 0; i < finished_processes_count; ++i)
-    {
-        if (wta_values[i] != NULL)
-        {
-            free(wta_values[i]);
-        }
-    }
-
-    free(wta_values);
 }
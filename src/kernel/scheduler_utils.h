@@ -1,13 +1,15 @@
 #pragma once
 
 #include "pcb.h"
-#include "min_heap.h"
-#include "queue.h"
+#include "ready_queue.h"
+#include "deque.h"
 
 // Function prototypes
-int compare_processes(const void* p1, const void* p2);
-PCB* hpf(min_heap_t* ready_queue, int current_time);
-PCB* srtn(min_heap_t* ready_queue);
-PCB* rr(Queue* ready_queue, int current_time);
+PCB* hpf(ready_queue_t* ready_queue, int current_time);
+PCB* srtn(ready_queue_t* ready_queue, int current_time);
+PCB* rr(Deque* ready_queue, int current_time);
+int open_scheduler_log();
 void log_process_state(PCB* process, char* state, int time);
-void generate_statistics();
\ No newline at end of file
+void record_finished_process(PCB* process, int time);
+void free_finished_processes();
+void generate_statistics(int total_execution_time);
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string.h>
+
+/*
+ * Formatting for the per-event lines of scheduler.log and the per-process
+ * rows of scheduler.perf. A DES run writes millions of them and fprintf's
+ * format parsing was most of its time; these append to a caller's buffer,
+ * which then goes out with a single fwrite.
+ */
+
+// Appends the decimal digits of value, as "%d" would, returns the new end
+static inline char* format_int(char* out, int value)
+{
+    char digits[12];
+    int count = 0;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+        *out++ = '-';
+    while (count)
+        *out++ = digits[--count];
+    return out;
+}
+
+// Appends text without its terminator, returns the new end
+static inline char* format_str(char* out, const char* text)
+{
+    size_t length = strlen(text);
+    memcpy(out, text, length);
+    return out + length;
+}
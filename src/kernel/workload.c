@@ -0,0 +1,393 @@
+#include "workload.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "colors.h"
+#include "logging.h"
+
+// Consumed pages are dropped from the mapping in chunks of this size
+#define WORKLOAD_RELEASE_CHUNK (64 * 1024 * 1024)
+
+// Validates a binary header and points the reader at its columns
+static int map_binary_columns(workload_reader_t* reader)
+{
+    const workload_header_t* header = (const workload_header_t*)reader->data;
+    if (header->version != WORKLOAD_VERSION)
+    {
+        LOG(LOG_PROC_GENERATOR, LOG_ERROR, "[PROC_GENERATOR] Unsupported binary workload version %u\n",
+            header->version);
+        return -1;
+    }
+
+    reader->binary = 1;
+    reader->count = header->count;
+    for (int i = 0; i < WORKLOAD_MAX_COLUMNS; i++)
+    {
+        reader->columns[i] = NULL;
+        if (!(header->columns & (1u << i)))
+            continue;
+
+        uint64_t offset = header->column_offset[i];
+        if (offset % sizeof(int32_t) != 0 || offset > reader->size ||
+            header->count > (reader->size - offset) / sizeof(int32_t))
+        {
+            LOG(LOG_PROC_GENERATOR, LOG_ERROR, "[PROC_GENERATOR] Binary workload column %d is out of bounds\n", i);
+            return -1;
+        }
+        reader->columns[i] = (const int32_t*)(reader->data + offset);
+    }
+
+    for (int i = 0; i < WORKLOAD_REQUIRED_COLUMNS; i++)
+        if (reader->columns[i] == NULL)
+        {
+            LOG(LOG_PROC_GENERATOR, LOG_ERROR, "[PROC_GENERATOR] Binary workload is missing column %d\n", i);
+            return -1;
+        }
+    return 0;
+}
+
+/*
+ * Maps the workload file, returns 0 on success and -1 (with errno set) on failure.
+ * Binary workloads are recognised by their magic, anything else is parsed as text.
+ */
+int workload_open(workload_reader_t* reader, const char* filename)
+{
+    reader->fd = -1;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->pos = 0;
+    reader->released = 0;
+    reader->line = 0;
+    reader->binary = 0;
+    reader->count = 0;
+    reader->index = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    reader->fd = fd;
+    reader->size = st.st_size;
+    if (reader->size == 0)
+        return 0;
+
+    void* data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close(fd);
+        reader->fd = -1;
+        return -1;
+    }
+    madvise(data, reader->size, MADV_SEQUENTIAL);
+    reader->data = (const char*)data;
+
+    if (reader->size >= sizeof(workload_header_t) && memcmp(data, WORKLOAD_MAGIC, 8) == 0)
+    {
+        if (map_binary_columns(reader) == -1)
+        {
+            workload_close(reader);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parses one integer at the cursor, stops at the end of the line
+static int parse_int(workload_reader_t* reader, int* value)
+{
+    const char* data = reader->data;
+    size_t pos = reader->pos;
+
+    while (pos < reader->size && is_blank(data[pos]))
+        pos++;
+
+    int negative = 0;
+    if (pos < reader->size && (data[pos] == '-' || data[pos] == '+'))
+        negative = data[pos++] == '-';
+
+    if (pos >= reader->size || data[pos] < '0' || data[pos] > '9')
+    {
+        reader->pos = pos;
+        return 0;
+    }
+
+    long result = 0;
+    while (pos < reader->size && data[pos] >= '0' && data[pos] <= '9')
+        result = result * 10 + (data[pos++] - '0');
+
+    reader->pos = pos;
+    *value = (int)(negative ? -result : result);
+    return 1;
+}
+
+static void skip_line(workload_reader_t* reader)
+{
+    const char* newline = memchr(reader->data + reader->pos, '\n', reader->size - reader->pos);
+    reader->pos = newline ? (size_t)(newline - reader->data) + 1 : reader->size;
+    reader->line++;
+}
+
+// Hands fully consumed pages back so a long trace does not stay resident
+static void release_consumed(workload_reader_t* reader)
+{
+    if (reader->pos - reader->released < WORKLOAD_RELEASE_CHUNK)
+        return;
+
+    long page = sysconf(_SC_PAGESIZE);
+    size_t end = reader->pos & ~((size_t)page - 1);
+    madvise((void*)(reader->data + reader->released), end - reader->released, MADV_DONTNEED);
+    reader->released = end;
+}
+
+/*
+ * Parses the next "id arrival runtime priority [memsize [io_interval [io_device]]]" record into params.
+ * Blank lines, comment lines and malformed lines are skipped, missing optional columns are 0.
+ * Returns 1 when a record was read and 0 at the end of the file.
+ */
+int workload_next(workload_reader_t* reader, processParameters* params)
+{
+    if (reader->binary)
+    {
+        if (reader->index >= reader->count)
+            return 0;
+
+        uint64_t i = reader->index++;
+        params->mtype = 1;
+        params->id = reader->columns[WORKLOAD_COLUMN_ID][i];
+        params->pid = -1;
+        params->arrival_time = reader->columns[WORKLOAD_COLUMN_ARRIVAL][i];
+        params->runtime = reader->columns[WORKLOAD_COLUMN_RUNTIME][i];
+        params->priority = reader->columns[WORKLOAD_COLUMN_PRIORITY][i];
+        params->memsize = reader->columns[WORKLOAD_COLUMN_MEMSIZE] ? reader->columns[WORKLOAD_COLUMN_MEMSIZE][i] : 0;
+        params->io_interval = reader->columns[WORKLOAD_COLUMN_IO_INTERVAL] ?
+                                  reader->columns[WORKLOAD_COLUMN_IO_INTERVAL][i] : 0;
+        params->io_device = reader->columns[WORKLOAD_COLUMN_IO_DEVICE] ?
+                                reader->columns[WORKLOAD_COLUMN_IO_DEVICE][i] : 0;
+        return 1;
+    }
+
+    while (reader->pos < reader->size)
+    {
+        while (reader->pos < reader->size && is_blank(reader->data[reader->pos]))
+            reader->pos++;
+        if (reader->pos >= reader->size)
+            break;
+
+        char c = reader->data[reader->pos];
+        if (c == '\n')
+        {
+            reader->pos++;
+            reader->line++;
+            continue;
+        }
+        if (c == '#')
+        {
+            skip_line(reader);
+            continue;
+        }
+
+        int id, arrival, runtime, priority, memsize = 0, io_interval = 0, io_device = 0;
+        int parsed = parse_int(reader, &id) && parse_int(reader, &arrival) && parse_int(reader, &runtime) &&
+            parse_int(reader, &priority);
+        // Each optional column is only looked for after the one before it
+        if (parsed && parse_int(reader, &memsize) && parse_int(reader, &io_interval))
+            parse_int(reader, &io_device);
+        int line = reader->line + 1;
+        skip_line(reader);
+
+        if (!parsed)
+        {
+            LOG(LOG_PROC_GENERATOR, LOG_WARN, "[PROC_GENERATOR] Skipping malformed line %d\n", line);
+            continue;
+        }
+
+        params->mtype = 1; // Default message type
+        params->id = id;
+        params->pid = -1;
+        params->arrival_time = arrival;
+        params->runtime = runtime;
+        params->priority = priority;
+        params->memsize = memsize;
+        params->io_interval = io_interval;
+        params->io_device = io_device;
+
+        release_consumed(reader);
+        return 1;
+    }
+    return 0;
+}
+
+// Whether a binary workload has the memory size column, text records are checked one by one
+int workload_has_memsize(workload_reader_t* reader)
+{
+    return reader->binary && reader->columns[WORKLOAD_COLUMN_MEMSIZE] != NULL;
+}
+
+// Whether a binary workload has the I/O interval column
+int workload_has_io(workload_reader_t* reader)
+{
+    return reader->binary && reader->columns[WORKLOAD_COLUMN_IO_INTERVAL] != NULL;
+}
+
+void workload_close(workload_reader_t* reader)
+{
+    if (reader->data)
+        munmap((void*)reader->data, reader->size);
+    if (reader->fd != -1)
+        close(reader->fd);
+    reader->data = NULL;
+    reader->fd = -1;
+}
+
+static int writer_has_column(workload_writer_t* writer, int column)
+{
+    if (column == WORKLOAD_COLUMN_MEMSIZE)
+        return writer->with_memsize;
+    if (column == WORKLOAD_COLUMN_IO_INTERVAL || column == WORKLOAD_COLUMN_IO_DEVICE)
+        return writer->with_io;
+    return 1;
+}
+
+// Text records place the I/O columns after the memory size, so I/O brings the memory size column along
+static int text_has_memsize(workload_writer_t* writer)
+{
+    return writer->with_memsize || writer->with_io;
+}
+
+// The text header names the columns, so it waits until with_memsize and with_io are final
+static int write_text_header(workload_writer_t* writer)
+{
+    writer->header_written = 1;
+    const char* header = writer->with_io ? "#id arrival runtime priority memsize io_interval io_device\n"
+                             : writer->with_memsize ? "#id arrival runtime priority memsize\n"
+                             : "#id arrival runtime priority\n";
+    return fprintf(writer->file, "%s", header) < 0 ? -1 : 0;
+}
+
+int workload_writer_open(workload_writer_t* writer, const char* filename, int binary)
+{
+    writer->binary = binary;
+    writer->with_memsize = 0;
+    writer->with_io = 0;
+    writer->header_written = 0;
+    writer->count = 0;
+    writer->capacity = 0;
+    for (int i = 0; i < WORKLOAD_WRITER_COLUMNS; i++)
+        writer->columns[i] = NULL;
+
+    writer->file = fopen(filename, binary ? "wb" : "w");
+    if (!writer->file)
+        return -1;
+    return 0;
+}
+
+int workload_write(workload_writer_t* writer, const processParameters* params)
+{
+    if (!writer->binary)
+    {
+        if (!writer->header_written && write_text_header(writer) == -1)
+            return -1;
+        if (writer->with_io)
+            return fprintf(writer->file, "%d\t%d\t%d\t%d\t%d\t%d\t%d\n", params->id, params->arrival_time,
+                           params->runtime, params->priority, params->memsize, params->io_interval,
+                           params->io_device) < 0 ? -1 : 0;
+        if (text_has_memsize(writer))
+            return fprintf(writer->file, "%d\t%d\t%d\t%d\t%d\n", params->id, params->arrival_time, params->runtime,
+                           params->priority, params->memsize) < 0 ? -1 : 0;
+        return fprintf(writer->file, "%d\t%d\t%d\t%d\n", params->id, params->arrival_time, params->runtime,
+                       params->priority) < 0 ? -1 : 0;
+    }
+
+    if (writer->count == writer->capacity)
+    {
+        uint64_t new_capacity = writer->capacity ? writer->capacity * 2 : 1024;
+        for (int i = 0; i < WORKLOAD_WRITER_COLUMNS; i++)
+        {
+            if (!writer_has_column(writer, i))
+                continue;
+            int32_t* grown = (int32_t*)realloc(writer->columns[i], new_capacity * sizeof(int32_t));
+            if (!grown)
+                return -1;
+            writer->columns[i] = grown;
+        }
+        writer->capacity = new_capacity;
+    }
+
+    uint64_t i = writer->count++;
+    writer->columns[WORKLOAD_COLUMN_ID][i] = params->id;
+    writer->columns[WORKLOAD_COLUMN_ARRIVAL][i] = params->arrival_time;
+    writer->columns[WORKLOAD_COLUMN_RUNTIME][i] = params->runtime;
+    writer->columns[WORKLOAD_COLUMN_PRIORITY][i] = params->priority;
+    if (writer->with_memsize)
+        writer->columns[WORKLOAD_COLUMN_MEMSIZE][i] = params->memsize;
+    if (writer->with_io)
+    {
+        writer->columns[WORKLOAD_COLUMN_IO_INTERVAL][i] = params->io_interval;
+        writer->columns[WORKLOAD_COLUMN_IO_DEVICE][i] = params->io_device;
+    }
+    return 0;
+}
+
+/*
+ * Flushes the file, for binary workloads this writes the header and every column.
+ * Returns 0 on success and -1 on a write error.
+ */
+int workload_writer_close(workload_writer_t* writer)
+{
+    int status = 0;
+    if (writer->binary)
+    {
+        workload_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, WORKLOAD_MAGIC, 8);
+        header.version = WORKLOAD_VERSION;
+        header.count = writer->count;
+
+        uint64_t offset = sizeof(header);
+        for (int i = 0; i < WORKLOAD_WRITER_COLUMNS; i++)
+        {
+            if (!writer_has_column(writer, i))
+                continue;
+            header.columns |= 1u << i;
+            header.column_offset[i] = offset;
+            offset += writer->count * sizeof(int32_t);
+        }
+
+        if (fwrite(&header, sizeof(header), 1, writer->file) != 1)
+            status = -1;
+        for (int i = 0; i < WORKLOAD_WRITER_COLUMNS && status == 0; i++)
+            if (writer_has_column(writer, i) && writer->count > 0 &&
+                fwrite(writer->columns[i], sizeof(int32_t), writer->count, writer->file) != writer->count)
+                status = -1;
+    }
+    else if (!writer->header_written)
+        status = write_text_header(writer);
+
+    for (int i = 0; i < WORKLOAD_WRITER_COLUMNS; i++)
+    {
+        free(writer->columns[i]);
+        writer->columns[i] = NULL;
+    }
+    if (fclose(writer->file) != 0)
+        status = -1;
+    writer->file = NULL;
+    return status;
+}
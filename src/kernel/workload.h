@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "headers.h"
+
+/*
+ * Binary workload: a header followed by one packed int32 array per column.
+ * Columns are located through column_offset (0 when the column is absent),
+ * the first four are required and the rest are optional extras.
+ */
+#define WORKLOAD_MAGIC "OSSIMWL1"
+#define WORKLOAD_VERSION 1
+
+#define WORKLOAD_COLUMN_ID 0
+#define WORKLOAD_COLUMN_ARRIVAL 1
+#define WORKLOAD_COLUMN_RUNTIME 2
+#define WORKLOAD_COLUMN_PRIORITY 3
+#define WORKLOAD_REQUIRED_COLUMNS 4
+#define WORKLOAD_COLUMN_MEMSIZE 4
+#define WORKLOAD_COLUMN_IO_INTERVAL 5
+#define WORKLOAD_COLUMN_IO_DEVICE 6
+#define WORKLOAD_WRITER_COLUMNS 7
+#define WORKLOAD_MAX_COLUMNS 8
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t columns; // Bitmask of the columns present
+    uint64_t count; // Number of records
+    uint64_t column_offset[WORKLOAD_MAX_COLUMNS]; // Byte offset of each column from the start of the file
+} workload_header_t;
+
+/*
+ * Streaming reader over a memory-mapped workload file, text or binary.
+ * Text records are parsed straight out of the mapping, one per workload_next()
+ * call, so only the record being dispatched is ever held in memory.
+ */
+typedef struct
+{
+    int fd;
+    const char* data;
+    size_t size;
+    size_t pos;
+    size_t released; // Bytes already handed back to the kernel
+    int line;
+
+    // Binary workloads
+    int binary;
+    uint64_t count;
+    uint64_t index;
+    const int32_t* columns[WORKLOAD_MAX_COLUMNS];
+} workload_reader_t;
+
+/*
+ * Writes either format, binary columns are buffered until workload_writer_close().
+ * Set with_memsize before the first write to add the memory size column and
+ * with_io to add the I/O interval and device columns, which text records
+ * always put after a memory size.
+ */
+typedef struct
+{
+    FILE* file;
+    int binary;
+    int with_memsize;
+    int with_io;
+    int header_written; // Text only
+    uint64_t count;
+    uint64_t capacity;
+    int32_t* columns[WORKLOAD_WRITER_COLUMNS];
+} workload_writer_t;
+
+int workload_open(workload_reader_t* reader, const char* filename);
+int workload_next(workload_reader_t* reader, processParameters* params);
+int workload_has_memsize(workload_reader_t* reader);
+int workload_has_io(workload_reader_t* reader);
+void workload_close(workload_reader_t* reader);
+
+int workload_writer_open(workload_writer_t* writer, const char* filename, int binary);
+int workload_write(workload_writer_t* writer, const processParameters* params);
+int workload_writer_close(workload_writer_t* writer);
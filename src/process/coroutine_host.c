@@ -0,0 +1,209 @@
+/*
+ * Coroutine host: runs many simulated jobs inside one OS process.
+ * Every job is a ucontext coroutine serving the commands of its own channel
+ * like run_process(), the host sleeps on the table-wide bell instead of one
+ * channel's doorbell, and on the ring's bell for arrivals.
+ */
+#include "process.h"
+#include <signal.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/shm.h>
+#include "clk.h"
+#include "colors.h"
+#include "logging.h"
+#include "process_host.h"
+#include "ipc_keys.h"
+#include "futex.h"
+
+#define JOB_STACK_SIZE (64 * 1024)
+
+typedef struct
+{
+    int id;
+    int channel;
+    int remaining;
+    int in_slice; // Job is in the middle of a command
+    int exited; // Told to exit before finishing
+    int slot; // Index in live_list
+    void* stack; // Mapped lazily on first dispatch
+    ucontext_t context;
+} job_coroutine_t;
+
+static job_coroutine_t* jobs[MAX_CHANNELS]; // By channel, each live job has its own
+static job_coroutine_t* live_list[MAX_CHANNELS]; // The first live_jobs entries, in no order
+static int live_jobs = 0;
+static ucontext_t host_context;
+static job_coroutine_t* current_job = NULL;
+
+static void add_job(int id, int runtime, int channel)
+{
+    job_coroutine_t* job = (job_coroutine_t*)calloc(1, sizeof(job_coroutine_t));
+    if (!job)
+    {
+        perror("[PROCESS] Failed to allocate job");
+        return;
+    }
+    job->id = id;
+    job->channel = channel;
+    job->remaining = runtime;
+    jobs[channel] = job;
+    job->slot = live_jobs;
+    live_list[live_jobs++] = job;
+}
+
+static void remove_job(job_coroutine_t* job)
+{
+    jobs[job->channel] = NULL;
+    job_coroutine_t* last = live_list[--live_jobs];
+    live_list[job->slot] = last;
+    last->slot = job->slot;
+    if (job->stack) munmap(job->stack, JOB_STACK_SIZE);
+    free(job);
+}
+
+// A job whose channel has a command it did not serve yet, NULL when none has
+static job_coroutine_t* next_pending_job()
+{
+    // The scheduler rings one channel at a time, the latest one is nearly always the job to switch to
+    int rung = channel_table->last_rung;
+    if (rung >= 0 && jobs[rung] && command_pending(&channel_table->channels[rung]))
+        return jobs[rung];
+    // Commands rung back to back, like EXIT on every channel at the end, leave only the last in last_rung
+    for (int i = 0; i < live_jobs; i++)
+        if (command_pending(&channel_table->channels[live_list[i]->channel]))
+            return live_list[i];
+    return NULL;
+}
+
+static void yield_to_host()
+{
+    swapcontext(&current_job->context, &host_context);
+}
+
+// Body of every job, the same command loop as run_process()
+static void job_main()
+{
+    job_coroutine_t* job = current_job;
+    command_channel_t* channel = &channel_table->channels[job->channel];
+
+    // Like run_process(), a job with no runtime answers its first command as DONE before it ends
+    int answered = 0;
+    while (job->remaining > 0 || !answered)
+    {
+        int doorbell = command_pending(channel);
+        if (doorbell == 0)
+        {
+            job->in_slice = 0;
+            yield_to_host();
+            continue;
+        }
+
+        // Only this job can run until the command is served, so the whole host sleeps through it
+        job->in_slice = 1;
+        int ran = serve_command(channel, doorbell, job->remaining);
+        if (ran == -1)
+        {
+            job->exited = 1;
+            break;
+        }
+        answered = 1;
+        job->remaining -= ran;
+        LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Job %d finished command, remaining: %d\n", job->id, job->remaining);
+    }
+
+    job->in_slice = 0;
+    if (job->exited)
+        return;
+    kill(process_generator_pid, SIGCHLD);
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Job %d finished execution.\n", job->id);
+    // uc_link returns to the host loop
+}
+
+static int start_job(job_coroutine_t* job)
+{
+    job->stack = mmap(NULL, JOB_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1, 0);
+    if (job->stack == MAP_FAILED)
+    {
+        perror("[PROCESS] Failed to map job stack");
+        job->stack = NULL;
+        return -1;
+    }
+    getcontext(&job->context);
+    job->context.uc_stack.ss_sp = job->stack;
+    job->context.uc_stack.ss_size = JOB_STACK_SIZE;
+    job->context.uc_link = &host_context;
+    makecontext(&job->context, job_main, 0);
+    return 0;
+}
+
+void run_coroutine_host()
+{
+    int ring_shmid = shmget(ipc_key(HOST_SHM_KEY), sizeof(process_host_t), 0666);
+    process_host_t* host = (ring_shmid == -1) ? (void*)-1 : shmat(ring_shmid, NULL, 0);
+    if ((void*)host == (void*)-1)
+    {
+        perror("[PROCESS] Error attaching coroutine host ring");
+        return;
+    }
+
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Coroutine host %d started\n", getpid());
+
+    attach_process_resources();
+
+    job_coroutine_t* running = NULL;
+    // Only the host moves tail
+    unsigned int tail = host->tail;
+    for (;;)
+    {
+        // Read before the ring and the channels, so a change after them still ends the sleep below
+        int ring_bell = __atomic_load_n(&host->bell, __ATOMIC_ACQUIRE);
+        int bell = __atomic_load_n(&channel_table->bell, __ATOMIC_ACQUIRE);
+        int done = __atomic_load_n(&host->done, __ATOMIC_ACQUIRE);
+
+        // Take in every job queued by the generator
+        unsigned int head = __atomic_load_n(&host->head, __ATOMIC_ACQUIRE);
+        for (; tail != head; tail++)
+        {
+            host_job_t* arrival = &host->ring[tail % HOST_RING_SIZE];
+            add_job(arrival->id, arrival->runtime, arrival->channel);
+        }
+        __atomic_store_n(&host->tail, tail, __ATOMIC_RELEASE);
+
+        if (done && live_jobs == 0)
+            break;
+
+        job_coroutine_t* job = running ? NULL : next_pending_job();
+        if (job && (job->stack || start_job(job) == 0))
+            running = job;
+        if (running == NULL)
+        {
+            // Sleep until the scheduler rings a channel or the generator assigns a job
+            int* const words[] = {&channel_table->bell, &host->bell};
+            const int expected[] = {bell, ring_bell};
+            futex_wait_any(words, expected, 2, 0);
+            continue;
+        }
+
+        current_job = running;
+        swapcontext(&host_context, &running->context);
+        current_job = NULL;
+
+        if ((running->remaining <= 0 || running->exited) && !running->in_slice)
+        {
+            remove_job(running);
+            running = NULL;
+        }
+        else if (!running->in_slice && !command_pending(&channel_table->channels[running->channel]))
+            running = NULL;
+    }
+
+    shmdt(host);
+    shmdt(channel_table);
+    destroy_clk(0);
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Coroutine host %d finished.\n", getpid());
+}
@@ -8,236 +8,229 @@
 #include <sys/shm.h>
 #include "clk.h"
 #include "colors.h"
-#include "shared_mem.h"
+#include "logging.h"
+#include "process_pool.h"
+#include "ipc_keys.h"
+#include "futex.h"
+#include "latency.h"
 
 pid_t process_generator_pid;
-int proc_shmid = -1;
+channel_table_t* channel_table = NULL; // Mapped once by attach_process_resources()
 
 
-void run_process(int runtime)
+void attach_process_resources()
 {
-    // Get shared memory ID
-    proc_shmid = shmget(SHM_KEY, sizeof(process_info_t), 0666);
-    if (proc_shmid == -1)
+    // The generator creates the channels before it starts any process
+    int channel_shmid = shmget(ipc_key(CHANNEL_SHM_KEY), sizeof(channel_table_t), 0666);
+    channel_table = (channel_shmid == -1) ? (void*)-1 : shmat(channel_shmid, NULL, 0);
+    if ((void*)channel_table == (void*)-1)
     {
-        if (DEBUG)
-            perror("[PROCESS] Error getting shared memory");
-        proc_shmid = -1;
+        perror("[PROCESS] Error attaching the command channels");
+        exit(EXIT_FAILURE);
     }
 
     // Sync clock before any get_clk() usage!
     sync_clk();
+}
 
-    // Make the process wait when spawned until it is told to run
-    while (!get_process_status(proc_shmid));
-
-    if (DEBUG)
-        printf(ANSI_COLOR_YELLOW"[PROCESS] %d Woke Up For The First Time\n"ANSI_COLOR_WHITE, getpid());
-    if (DEBUG)
-        printf(ANSI_COLOR_YELLOW"[PROCESS] Process %d started with runtime %d seconds.\n"ANSI_COLOR_WHITE, getpid(),
-               runtime);
-    int remaining = runtime;
-    while (remaining > 0)
-    {
-        // Continuously check status from shared memory
-        // If status is 1 and current_clk matches, run the process
-        if (get_process_status(proc_shmid) && get_process_info(proc_shmid).current_clk == get_clk())
-        {
-            int time_to_run = 0;
-            while (time_to_run <= 0)
-            {
-                time_to_run = get_time_to_run(proc_shmid, getpid());
-            }
-            if (time_to_run > remaining)
-                time_to_run = remaining;
-
-            printf(ANSI_COLOR_YELLOW"[PROCESS] Process %d will run for %d units (remaining: %d)\n"ANSI_COLOR_WHITE,
-                   getpid(), time_to_run, remaining);
-
-            int start_time = get_clk();
-            int elapsed = 0;
-
-            // At each tick, check handshake and status
-            while (elapsed < time_to_run)
-            {
-                int now = get_clk();
-                if (now != start_time)
-                {
-                    if (DEBUG)
-                        printf(
-                            ANSI_COLOR_YELLOW
-                            "[PROCESS] PID %d ran for 1 second. Remaining: %d, Remaining in slice: %d\n"
-                            ANSI_COLOR_WHITE,
-                            getpid(), remaining - elapsed - 1, time_to_run - elapsed - 1);
-                    elapsed++;
-                    start_time = now;
-                }
-            }
-
-            // Update remaining time
-            remaining -= time_to_run;
-            update_process_status(proc_shmid, getpid(), 0);
-            if (DEBUG)
-                printf(ANSI_COLOR_YELLOW"[PROCESS] Process %d finished time slice, remaining: %d\n"ANSI_COLOR_WHITE,
-                       getpid(), remaining);
-        }
-        else if (get_process_info(proc_shmid).pid != getpid())
-            raise(SIGTSTP);
-    }
-
-    // Finished execution
-    update_process_status(proc_shmid, getpid(), 0);
-    kill(process_generator_pid, SIGCHLD);
-    if (DEBUG)
-        printf(ANSI_COLOR_YELLOW"[PROCESS] Sending SIGCHLD to: %d\n"ANSI_COLOR_WHITE, process_generator_pid);
-    printf(ANSI_COLOR_YELLOW"[PROCESS] Process %d finished execution.\n"ANSI_COLOR_WHITE, getpid());
-    destroy_clk(0);
+int command_pending(command_channel_t* channel)
+{
+    int doorbell = __atomic_load_n(&channel->doorbell, __ATOMIC_ACQUIRE);
+    return doorbell != channel->acked ? doorbell : 0;
 }
 
-int main(int argc, char* argv[])
+static void acknowledge(command_channel_t* channel, int doorbell)
 {
-    signal(SIGINT, sigIntHandler);
-    signal(SIGCONT, sigContHandler);
-    signal(SIGTSTP, sigStpHandler);
+    __atomic_store_n(&channel->acked, doorbell, __ATOMIC_RELEASE);
+    futex_wake_all(&channel->acked);
+}
 
-    if (argc < 3)
+int serve_command(command_channel_t* channel, int doorbell, int remaining)
+{
+    if (channel->command == CHANNEL_EXIT)
     {
-        fprintf(stderr, "Usage: %s <runtime> <process_generator_pid>\n", argv[0]);
-        return 1;
+        acknowledge(channel, doorbell);
+        return -1;
+    }
+    if (channel->command != CHANNEL_RUN)
+    {
+        channel->state = remaining > 0 ? CHANNEL_STOPPED : CHANNEL_DONE;
+        acknowledge(channel, doorbell);
+        return 0;
     }
 
-    int runtime = atoi(argv[1]);
-    process_generator_pid = atoi(argv[2]);
+    LATENCY_STAMP(channel->observed_ns);
+    int time_to_run = channel->ticks < remaining ? channel->ticks : remaining;
+    channel->state = CHANNEL_RUNNING;
+    // A slice rung for a later tick starts once the clock gets there
+    int now = wait_clk(channel->posted_clk);
 
-    if (runtime < 0 || process_generator_pid < 0)
+    // Sleep through the slice a tick at a time, a stop rung meanwhile ends it at the next tick
+    int ran = 0;
+    while (ran < time_to_run && __atomic_load_n(&channel->doorbell, __ATOMIC_ACQUIRE) == doorbell)
     {
-        if (runtime < 0)
-            fprintf(stderr, "Runtime must be a positive integer.\n");
-        else
-            fprintf(stderr, "process_generator_pid must be a positive integer.\n");
-        return 1;
+        now = wait_clk(now + 1);
+        ran++;
+        LOG(LOG_PROCESS, LOG_TRACE, "[PROCESS] PID %d ran for 1 second. Remaining: %d, Remaining in slice: %d\n",
+            getpid(), remaining - ran, time_to_run - ran);
     }
 
-    run_process(runtime);
-    return 0;
+    channel->ran = ran;
+    channel->state = (ran == remaining) ? CHANNEL_DONE : CHANNEL_IDLE;
+    LATENCY_STAMP(channel->acked_ns);
+    acknowledge(channel, doorbell);
+    return ran;
 }
 
-
-void sigIntHandler(int signum)
+/*
+ * Sleeps until the scheduler rings the channel, returns the doorbell value
+ * of the new command.
+ */
+static int wait_for_command(command_channel_t* channel)
 {
-    printf(ANSI_COLOR_YELLOW "[PROCESS] Process %d received SIGINT. Terminating...\n"ANSI_COLOR_WHITE, getpid());
-    destroy_clk(0);
-    exit(0);
+    int doorbell;
+    while ((doorbell = command_pending(channel)) == 0)
+        futex_wait(&channel->doorbell, channel->acked, NULL);
+    return doorbell;
 }
 
-void sigStpHandler(int signum)
+void run_process(int runtime, int channel_index)
 {
-    // Update status in shared memory to not running
-    // update_process_status(proc_shmid, getpid(), 0);
-    if (DEBUG)
-        printf(ANSI_COLOR_YELLOW "[PROCESS] Process %d stopped.\n"ANSI_COLOR_WHITE, getpid());
+    command_channel_t* channel = &channel_table->channels[channel_index];
 
-    pause();
-    signal(SIGTSTP, sigStpHandler);
-}
-
-void sigContHandler(int signum)
-{
-    // Uncomment this for more explicit resume logging
-    if (DEBUG)
-        printf(ANSI_COLOR_YELLOW"[PROCESS] Process %d received SIGCONT. Resuming...\n"ANSI_COLOR_WHITE, getpid());
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d started with runtime %d seconds on channel %d.\n", getpid(),
+        runtime, channel_index);
+    int remaining = runtime;
+    // A job with no runtime still answers its first command, as DONE, the scheduler waits for that answer
+    int answered = 0;
+    while (remaining > 0 || !answered)
+    {
+        int doorbell = wait_for_command(channel);
+        if (channel->command == CHANNEL_RUN)
+            LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d will run for %d units (remaining: %d)\n", getpid(),
+                channel->ticks < remaining ? channel->ticks : remaining, remaining);
 
-    // Update status in shared memory to running
-    update_process_status(proc_shmid, getpid(), 1);
+        int ran = serve_command(channel, doorbell, remaining);
+        if (ran == -1)
+        {
+            LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d told to exit.\n", getpid());
+            return;
+        }
+        answered = 1;
+        remaining -= ran;
+        LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d finished command, remaining: %d\n", getpid(), remaining);
+    }
 
-    signal(SIGCONT, sigContHandler);
+    // Finished execution
+    kill(process_generator_pid, SIGCHLD);
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Sending SIGCHLD to: %d\n", process_generator_pid);
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d finished execution.\n", getpid());
 }
 
-process_info_t get_process_info(int proc_shmid)
+/*
+ * Pool worker: stays alive across jobs, blocking on its control block
+ * until the generator assigns the next job or tells it to exit.
+ */
+void run_worker(int slot)
 {
-    process_info_t process_info = {.status = -1, .pid = -1, .time_to_run = -1, .current_clk = -1};
-
-    if (proc_shmid == -1) return process_info;
-    process_info_t* shm = (process_info_t*)shmat(proc_shmid, NULL, 0);
-    if ((void*)shm == (void*)-1)
+    int pool_shmid = shmget(ipc_key(POOL_SHM_KEY), sizeof(process_pool_t), 0666);
+    if (pool_shmid == -1)
     {
-        if (DEBUG)
-            perror("Error attaching shared memory in process");
-        return process_info;
+        perror("[PROCESS] Error getting process pool shared memory");
+        return;
     }
+    process_pool_t* pool = (process_pool_t*)shmat(pool_shmid, NULL, 0);
+    if ((void*)pool == (void*)-1)
+    {
+        perror("[PROCESS] Error attaching process pool shared memory");
+        return;
+    }
+    pool_worker_t* worker = &pool->workers[slot];
+    attach_process_resources();
 
-    if (shm->pid == getpid())
+    while (1)
     {
-        process_info.time_to_run = shm->time_to_run;
-        process_info.status = shm->status;
-        process_info.pid = shm->pid;
-        process_info.current_clk = shm->current_clk;
-        shmdt(shm);
-        return process_info;
+        // Interrupted waits just go back to sleep
+        while (sem_wait(&worker->job_ready) == -1 && errno == EINTR);
+        if (worker->state == WORKER_EXIT)
+            break;
+
+        LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Worker %d picked up process %d\n", getpid(), worker->id);
+        run_process(worker->runtime, worker->channel);
+        worker->state = WORKER_IDLE;
     }
 
-    shmdt(shm);
-    return process_info;
+    shmdt(pool);
+    destroy_clk(0);
 }
 
-int get_time_to_run(int proc_shmid, pid_t pid)
+int main(int argc, char* argv[])
 {
-    if (proc_shmid == -1) return -1;
-    process_info_t* shm = (process_info_t*)shmat(proc_shmid, NULL, 0);
-    if ((void*)shm == (void*)-1)
-    {
-        if (DEBUG)
+    signal(SIGINT, sigIntHandler);
 
-            perror("Error attaching shared memory in process");
-        return -1;
-    }
-    int remaining_time = -1;
-    int status = 0;
-    if (shm->pid == pid && shm->status == 1 && shm->current_clk == get_clk())
+    if (argc < 3)
     {
-        remaining_time = shm->time_to_run;
-        status = shm->status;
+        fprintf(stderr, "Usage: %s <runtime> <process_generator_pid> <channel>\n", argv[0]);
+        fprintf(stderr, "       %s -w <worker_slot> <process_generator_pid>\n", argv[0]);
+        fprintf(stderr, "       %s -c <process_generator_pid>\n", argv[0]);
+        return 1;
     }
-    else
+
+    if (strcmp(argv[1], "-c") == 0)
     {
-        // Process is not running, return -1
-        remaining_time = -1;
+        process_generator_pid = atoi(argv[2]);
+        run_coroutine_host();
+        return 0;
     }
 
-    shmdt(shm);
-    return status ? remaining_time : -1;
-}
-
-int get_process_status(int proc_shmid)
-{
-    if (proc_shmid == -1) return 0;
-    process_info_t* shm = (process_info_t*)shmat(proc_shmid, NULL, 0);
-    if ((void*)shm == (void*)-1)
+    if (strcmp(argv[1], "-w") == 0)
     {
-        if (DEBUG)
-
-            perror("Error attaching shared memory in process");
+        if (argc < 4)
+        {
+            fprintf(stderr, "Usage: %s -w <worker_slot> <process_generator_pid>\n", argv[0]);
+            return 1;
+        }
+        int slot = atoi(argv[2]);
+        process_generator_pid = atoi(argv[3]);
+        if (slot < 0 || slot >= MAX_POOL_WORKERS)
+        {
+            fprintf(stderr, "Worker slot must be between 0 and %d.\n", MAX_POOL_WORKERS - 1);
+            return 1;
+        }
+        run_worker(slot);
         return 0;
     }
 
-    int status = 0;
-    if (shm->pid == getpid() && shm->current_clk == get_clk())
+    if (argc < 4)
     {
-        status = shm->status;
+        fprintf(stderr, "Usage: %s <runtime> <process_generator_pid> <channel>\n", argv[0]);
+        return 1;
     }
+    int runtime = atoi(argv[1]);
+    process_generator_pid = atoi(argv[2]);
+    int channel = atoi(argv[3]);
 
-    shmdt(shm);
-    return status;
-}
+    if (runtime < 0 || process_generator_pid < 0 || channel < 0 || channel >= MAX_CHANNELS)
+    {
+        if (runtime < 0)
+            fprintf(stderr, "Runtime must be a positive integer.\n");
+        else if (process_generator_pid < 0)
+            fprintf(stderr, "process_generator_pid must be a positive integer.\n");
+        else
+            fprintf(stderr, "Channel must be between 0 and %d.\n", MAX_CHANNELS - 1);
+        return 1;
+    }
 
-void update_process_status(int proc_shmid, pid_t pid, int status)
-{
-    if (proc_shmid == -1) return;
-    process_info_t* shm = (process_info_t*)shmat(proc_shmid, NULL, 0);
-    if ((void*)shm == (void*)-1) return;
+    attach_process_resources();
+    run_process(runtime, channel);
+    destroy_clk(0);
+    return 0;
+}
 
-    if (shm->pid == pid)
-        shm->status = status;
 
-    shmdt(shm);
+void sigIntHandler(int signum)
+{
+    LOG(LOG_PROCESS, LOG_DEBUG, "[PROCESS] Process %d received SIGINT. Terminating...\n", getpid());
+    destroy_clk(0);
+    exit(0);
 }
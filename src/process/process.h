@@ -1,21 +1,18 @@
 #pragma once
 
 #include <signal.h>
-#include "shared_mem.h"
+#include "command_channel.h"
 
-// Add shared memory key definition
-#define SHM_KEY 400
-#define MAX_PROCESSES 100
+extern pid_t process_generator_pid;
 
 void sigIntHandler(int signum);
-void sigStpHandler(int signum);
-void sigContHandler(int signum);
-void run_process(int runtime);
-int get_time_to_run(int shmid, pid_t pid);
-void update_process_status(int proc_shmid, pid_t pid, int status);
-int get_process_status(int proc_shmid);
-int get_time_to_run(int proc_shmid, pid_t pid);
-process_info_t get_process_info(int proc_shmid);
-void sigIntHandler(int signum);
-void sigStpHandler(int signum);
-void sigContHandler(int signum);
\ No newline at end of file
+void attach_process_resources();
+// Runs the job on its channel, serving the scheduler's commands until its runtime is used up or it is told to exit
+void run_process(int runtime, int channel_index);
+void run_worker(int slot);
+void run_coroutine_host();
+// Doorbell value of the command waiting on the channel, 0 when the process has served every command
+int command_pending(command_channel_t* channel);
+// Serves the pending command, returns the ticks the job ran (0 for a stop) or -1 when told to exit.
+// A job with no time left reports CHANNEL_DONE whatever the command was
+int serve_command(command_channel_t* channel, int doorbell, int remaining);
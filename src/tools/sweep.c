@@ -0,0 +1,547 @@
+/*
+ * Parameter sweep driver.
+ * Runs os-sim over the grid algorithm x quantum x workload x seed, several
+ * configurations at a time, each in its own directory and IPC namespace,
+ * then collects every scheduler.perf into one CSV and one JSON table with
+ * the mean and 95% confidence interval of each metric across seeds.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define MAX_VALUES 256
+#define MAX_METRICS 64
+#define MAX_METRIC_NAME 64
+
+// Workloads starting with this prefix are generated per seed with os-sim-gen
+#define GENERATED_PREFIX "gen:"
+
+typedef struct
+{
+    char name[MAX_METRIC_NAME];
+    double value;
+} metric_t;
+
+typedef struct
+{
+    const char* algorithm;
+    int quantum; // -1 when the algorithm has no quantum
+    int workload; // Index into workloads
+    long seed; // -1 for workload files
+    pid_t pid;
+    int status; // Exit status, -1 while pending
+    int metric_count;
+    metric_t metrics[MAX_METRICS];
+} run_t;
+
+static char* algorithms[MAX_VALUES];
+static int algorithm_count = 0;
+static int quanta[MAX_VALUES];
+static int quantum_count = 0;
+static char* workloads[MAX_VALUES];
+static int workload_count = 0;
+static long seeds[MAX_VALUES];
+static int seed_count = 0;
+
+static char os_sim_path[PATH_MAX];
+static char process_path[PATH_MAX];
+static char gen_path[PATH_MAX];
+static const char* engine = "des";
+static const char* vm_policy = NULL; // Page replacement policy passed to every run, NULL for none
+static const char* work_dir = "sweep_runs";
+
+static int split_list(char* list, char** out)
+{
+    int count = 0;
+    for (char* item = strtok(list, ","); item && count < MAX_VALUES; item = strtok(NULL, ","))
+        out[count++] = item;
+    return count;
+}
+
+// Parses "1,2,5-8" into numbers
+static int parse_ranges(char* list, long* out)
+{
+    char* items[MAX_VALUES];
+    int item_count = split_list(list, items);
+    int count = 0;
+    for (int i = 0; i < item_count; i++)
+    {
+        long first, last;
+        if (sscanf(items[i], "%ld-%ld", &first, &last) != 2)
+            first = last = atol(items[i]);
+        for (long v = first; v <= last && count < MAX_VALUES; v++)
+            out[count++] = v;
+    }
+    return count;
+}
+
+static int is_generated(int workload)
+{
+    return strncmp(workloads[workload], GENERATED_PREFIX, strlen(GENERATED_PREFIX)) == 0;
+}
+
+// Writes the run's working directory with `suffix` appended, -1 when it does not fit
+static int run_path(int index, const char* suffix, char* buffer, size_t size)
+{
+    int length = snprintf(buffer, size, "%s/run-%d%s", work_dir, index, suffix);
+    return length < 0 || (size_t)length >= size ? -1 : 0;
+}
+
+// Child side of one configuration, never returns
+static void execute_run(run_t* run, int index)
+{
+    char dir[PATH_MAX];
+    if (run_path(index, "", dir, sizeof(dir)) == -1)
+    {
+        fprintf(stderr, "[SWEEP] Run directory under %s is too long\n", work_dir);
+        _exit(1);
+    }
+    mkdir(dir, 0755);
+    if (chdir(dir) == -1)
+    {
+        perror("[SWEEP] chdir failed");
+        _exit(1);
+    }
+
+    // os-sim ends by signalling its whole process group, keep it away from the sweep
+    setpgid(0, 0);
+    char ns[16];
+    snprintf(ns, sizeof(ns), "%d", index + 1);
+    setenv("OS_SIM_IPC_NS", ns, 1);
+
+    int out = open("os-sim.out", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out != -1)
+    {
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        close(out);
+    }
+
+    // The multi-process engine starts ./process from its working directory
+    unlink("process");
+    if (symlink(process_path, "process") == -1)
+        perror("[SWEEP] symlink process failed");
+
+    char workload_path[PATH_MAX];
+    if (is_generated(run->workload))
+    {
+        // Build "os-sim-gen <spec> -s <seed> -o processes.txt"
+        char* spec = strdup(workloads[run->workload] + strlen(GENERATED_PREFIX));
+        char* argv[MAX_VALUES + 6];
+        int argc = 0;
+        argv[argc++] = gen_path;
+        for (char* arg = strtok(spec, " "); arg && argc < MAX_VALUES; arg = strtok(NULL, " "))
+            argv[argc++] = arg;
+        char seed[32];
+        snprintf(seed, sizeof(seed), "%ld", run->seed);
+        argv[argc++] = "-s";
+        argv[argc++] = seed;
+        argv[argc++] = "-o";
+        argv[argc++] = "processes.txt";
+        argv[argc] = NULL;
+
+        pid_t gen = fork();
+        if (gen == 0)
+        {
+            execv(gen_path, argv);
+            perror("[SWEEP] execv os-sim-gen failed");
+            _exit(1);
+        }
+        int status;
+        if (gen < 0 || waitpid(gen, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            _exit(1);
+        snprintf(workload_path, sizeof(workload_path), "processes.txt");
+    }
+    else
+        snprintf(workload_path, sizeof(workload_path), "%s", workloads[run->workload]);
+
+    char quantum[16];
+    snprintf(quantum, sizeof(quantum), "%d", run->quantum > 0 ? run->quantum : 1);
+    char engine_arg[32];
+    snprintf(engine_arg, sizeof(engine_arg), "--engine=%s", engine);
+    char vm_arg[32];
+    snprintf(vm_arg, sizeof(vm_arg), "--vm=%s", vm_policy ? vm_policy : "");
+
+    char* argv[] = {
+        "os-sim", "-s", (char*)run->algorithm, "-q", quantum, "-f", workload_path, engine_arg,
+        vm_policy ? vm_arg : NULL, NULL
+    };
+    execv(os_sim_path, argv);
+    perror("[SWEEP] execv os-sim failed");
+    _exit(1);
+}
+
+// Reads every "name = value" line of scheduler.perf
+static void collect_metrics(run_t* run, int index)
+{
+    char path[PATH_MAX];
+    FILE* perf = run_path(index, "/scheduler.perf", path, sizeof(path)) == -1 ? NULL : fopen(path, "r");
+    if (!perf)
+    {
+        run->status = run->status ? run->status : 1;
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), perf) && run->metric_count < MAX_METRICS)
+    {
+        char* equals = strchr(line, '=');
+        if (!equals || line[0] == '#')
+            continue;
+
+        char* end = equals;
+        while (end > line && end[-1] == ' ')
+            end--;
+        size_t length = end - line;
+        if (length == 0 || length >= MAX_METRIC_NAME)
+            continue;
+
+        metric_t* metric = &run->metrics[run->metric_count];
+        memcpy(metric->name, line, length);
+        metric->name[length] = '\0';
+        if (sscanf(equals + 1, "%lf", &metric->value) == 1)
+            run->metric_count++;
+    }
+    fclose(perf);
+}
+
+// Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+static double t_quantile(int degrees)
+{
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (degrees < 1) return 0;
+    if (degrees <= 30) return table[degrees - 1];
+    return 1.960;
+}
+
+static int find_metric(run_t* run, const char* name)
+{
+    for (int i = 0; i < run->metric_count; i++)
+        if (strcmp(run->metrics[i].name, name) == 0)
+            return i;
+    return -1;
+}
+
+static void json_string(FILE* file, const char* value)
+{
+    fputc('"', file);
+    for (; *value; value++)
+    {
+        if (*value == '"' || *value == '\\')
+            fputc('\\', file);
+        fputc(*value, file);
+    }
+    fputc('"', file);
+}
+
+/*
+ * Writes <prefix>.csv (one row per configuration, mean and CI across seeds)
+ * and <prefix>.json (the same summary plus every individual run).
+ */
+static void write_results(run_t* runs, int run_count, const char* prefix)
+{
+    // Metric names as they first appear in any successful run
+    char names[MAX_METRICS][MAX_METRIC_NAME];
+    int name_count = 0;
+    for (int r = 0; r < run_count; r++)
+        for (int m = 0; m < runs[r].metric_count; m++)
+        {
+            int known = 0;
+            for (int n = 0; n < name_count && !known; n++)
+                known = strcmp(names[n], runs[r].metrics[m].name) == 0;
+            if (!known && name_count < MAX_METRICS)
+                strcpy(names[name_count++], runs[r].metrics[m].name);
+        }
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s.csv", prefix);
+    FILE* csv = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s.json", prefix);
+    FILE* json = fopen(path, "w");
+    if (!csv || !json)
+    {
+        perror("[SWEEP] Failed to open results");
+        if (csv) fclose(csv);
+        if (json) fclose(json);
+        return;
+    }
+
+    fprintf(csv, "workload,algorithm,quantum,runs,failed");
+    for (int n = 0; n < name_count; n++)
+        fprintf(csv, ",%s mean,%s ci95", names[n], names[n]);
+    fprintf(csv, "\n");
+    fprintf(json, "{\n  \"summary\": [");
+
+    // Runs of one configuration are consecutive, only the seed varies among them
+    int first_row = 1;
+    for (int start = 0; start < run_count;)
+    {
+        int end = start + 1;
+        while (end < run_count && runs[end].workload == runs[start].workload &&
+            runs[end].algorithm == runs[start].algorithm && runs[end].quantum == runs[start].quantum)
+            end++;
+
+        int succeeded = 0;
+        for (int r = start; r < end; r++)
+            succeeded += runs[r].status == 0;
+
+        fprintf(csv, "\"%s\",%s,%d,%d,%d", workloads[runs[start].workload], runs[start].algorithm,
+                runs[start].quantum, end - start, end - start - succeeded);
+        fprintf(json, "%s\n    {\"workload\": ", first_row ? "" : ",");
+        json_string(json, workloads[runs[start].workload]);
+        fprintf(json, ", \"algorithm\": \"%s\", \"quantum\": %d, \"runs\": %d, \"failed\": %d, \"metrics\": {",
+                runs[start].algorithm, runs[start].quantum, end - start, end - start - succeeded);
+        first_row = 0;
+
+        for (int n = 0; n < name_count; n++)
+        {
+            double sum = 0, sum_squares = 0;
+            int samples = 0;
+            for (int r = start; r < end; r++)
+            {
+                int m = runs[r].status == 0 ? find_metric(&runs[r], names[n]) : -1;
+                if (m == -1) continue;
+                sum += runs[r].metrics[m].value;
+                sum_squares += runs[r].metrics[m].value * runs[r].metrics[m].value;
+                samples++;
+            }
+            double mean = samples ? sum / samples : NAN;
+            double variance = samples > 1 ? (sum_squares - samples * mean * mean) / (samples - 1) : 0;
+            double ci = samples > 1 ? t_quantile(samples - 1) * sqrt(variance > 0 ? variance : 0) / sqrt(samples) : 0;
+
+            fprintf(csv, ",%.4f,%.4f", mean, ci);
+            fprintf(json, "%s", n ? ", " : "");
+            json_string(json, names[n]);
+            if (samples)
+                fprintf(json, ": {\"mean\": %.4f, \"ci95\": %.4f}", mean, ci);
+            else
+                fprintf(json, ": null");
+        }
+        fprintf(csv, "\n");
+        fprintf(json, "}}");
+        start = end;
+    }
+
+    fprintf(json, "\n  ],\n  \"runs\": [");
+    for (int r = 0; r < run_count; r++)
+    {
+        fprintf(json, "%s\n    {\"run\": %d, \"workload\": ", r ? "," : "", r);
+        json_string(json, workloads[runs[r].workload]);
+        fprintf(json, ", \"algorithm\": \"%s\", \"quantum\": %d, \"seed\": %ld, \"status\": %d, \"metrics\": {",
+                runs[r].algorithm, runs[r].quantum, runs[r].seed, runs[r].status);
+        for (int m = 0; m < runs[r].metric_count; m++)
+        {
+            fprintf(json, "%s", m ? ", " : "");
+            json_string(json, runs[r].metrics[m].name);
+            fprintf(json, ": %.4f", runs[r].metrics[m].value);
+        }
+        fprintf(json, "}}");
+    }
+    fprintf(json, "\n  ]\n}\n");
+
+    fclose(csv);
+    fclose(json);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s -w <workloads> [options]\n"
+            "  -a <algorithms>   comma-separated rr,hpf,srtn (default rr,hpf,srtn)\n"
+            "  -q <quanta>       RR quanta, e.g. 1-20 or 1,2,4 (default 2)\n"
+            "  -w <workloads>    comma-separated workload files, or \"gen:<os-sim-gen options>\"\n"
+            "                    to generate one workload per seed\n"
+            "  -r <seeds>        seeds for generated workloads, e.g. 1-10 (default 1)\n"
+            "  -j <jobs>         configurations run in parallel (default: online CPUs)\n"
+            "  -e <engine>       os-sim engine, des or proc (default des)\n"
+            "  -v <policy>       simulate paging with this page replacement policy in every run\n"
+            "  -d <dir>          directory for the per-run working directories (default sweep_runs)\n"
+            "  -o <prefix>       results go to <prefix>.csv and <prefix>.json (default sweep)\n",
+            name);
+}
+
+// Resolves a sibling executable of the sweep binary into a PATH_MAX buffer, -1 when it does not fit
+static int sibling_path(const char* self, const char* name, char* out)
+{
+    char dir[PATH_MAX];
+    if (!realpath(self, dir))
+        strcpy(dir, ".");
+    char* slash = strrchr(dir, '/');
+    if (slash) *slash = '\0';
+    size_t dir_length = strlen(dir);
+    size_t name_length = strlen(name);
+    if (dir_length + 1 + name_length >= PATH_MAX)
+        return -1;
+    memcpy(out, dir, dir_length);
+    out[dir_length] = '/';
+    memcpy(out + dir_length + 1, name, name_length + 1);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    char default_algorithms[] = "rr,hpf,srtn";
+    char default_quanta[] = "2";
+    char default_seeds[] = "1";
+    char* algorithm_list = default_algorithms;
+    char* quantum_list = default_quanta;
+    char* seed_list = default_seeds;
+    char* workload_list = NULL;
+    const char* prefix = "sweep";
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "a:q:w:r:j:e:v:d:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a': algorithm_list = optarg;
+            break;
+        case 'q': quantum_list = optarg;
+            break;
+        case 'w': workload_list = optarg;
+            break;
+        case 'r': seed_list = optarg;
+            break;
+        case 'j': jobs = atol(optarg);
+            break;
+        case 'e': engine = optarg;
+            break;
+        case 'v': vm_policy = optarg;
+            break;
+        case 'd': work_dir = optarg;
+            break;
+        case 'o': prefix = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!workload_list || jobs < 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    algorithm_count = split_list(algorithm_list, algorithms);
+    long parsed[MAX_VALUES];
+    quantum_count = parse_ranges(quantum_list, parsed);
+    for (int i = 0; i < quantum_count; i++)
+        quanta[i] = (int)parsed[i];
+    seed_count = parse_ranges(seed_list, seeds);
+    workload_count = split_list(workload_list, workloads);
+
+    if (sibling_path(argv[0], "os-sim", os_sim_path) == -1 || sibling_path(argv[0], "process", process_path) == -1 ||
+        sibling_path(argv[0], "os-sim-gen", gen_path) == -1)
+    {
+        fprintf(stderr, "[SWEEP] Path of the simulator executables is too long\n");
+        return 1;
+    }
+
+    // Workload files are opened from the run directories
+    char* resolved[MAX_VALUES];
+    for (int w = 0; w < workload_count; w++)
+    {
+        resolved[w] = NULL;
+        if (is_generated(w)) continue;
+        resolved[w] = realpath(workloads[w], NULL);
+        if (!resolved[w])
+        {
+            fprintf(stderr, "[SWEEP] Cannot find workload %s\n", workloads[w]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Expand the grid, seeds innermost so a configuration's runs are consecutive
+    int max_runs = workload_count * algorithm_count * quantum_count * seed_count;
+    run_t* runs = (run_t*)calloc(max_runs > 0 ? max_runs : 1, sizeof(run_t));
+    int run_count = 0;
+    for (int w = 0; w < workload_count; w++)
+        for (int a = 0; a < algorithm_count; a++)
+        {
+            int has_quantum = strcmp(algorithms[a], "rr") == 0;
+            for (int q = 0; q < (has_quantum ? quantum_count : 1); q++)
+                for (int s = 0; s < (is_generated(w) ? seed_count : 1); s++)
+                {
+                    run_t* run = &runs[run_count++];
+                    run->algorithm = algorithms[a];
+                    run->quantum = has_quantum ? quanta[q] : -1;
+                    run->workload = w;
+                    run->seed = is_generated(w) ? seeds[s] : -1;
+                    run->status = -1;
+                }
+        }
+
+    mkdir(work_dir, 0755);
+    printf("[SWEEP] Running %d configurations, %ld at a time\n", run_count, jobs);
+
+    int next = 0, running = 0, finished = 0;
+    while (finished < run_count)
+    {
+        while (running < jobs && next < run_count)
+        {
+            run_t* run = &runs[next];
+            char* original = workloads[run->workload];
+            if (resolved[run->workload])
+                workloads[run->workload] = resolved[run->workload];
+
+            pid_t pid = fork();
+            if (pid == 0)
+                execute_run(run, next);
+            workloads[run->workload] = original;
+            if (pid < 0)
+            {
+                perror("[SWEEP] fork failed");
+                run->status = 1;
+                finished++;
+            }
+            else
+            {
+                run->pid = pid;
+                running++;
+            }
+            next++;
+        }
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid == -1)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int r = 0; r < run_count; r++)
+        {
+            if (runs[r].pid != pid || runs[r].status != -1) continue;
+            runs[r].status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            collect_metrics(&runs[r], r);
+            running--;
+            finished++;
+            printf("[SWEEP] %d/%d done: %s q=%d seed=%ld status=%d\n", finished, run_count, runs[r].algorithm,
+                   runs[r].quantum, runs[r].seed, runs[r].status);
+            break;
+        }
+    }
+
+    write_results(runs, run_count, prefix);
+    printf("[SWEEP] Results written to %s.csv and %s.json\n", prefix, prefix);
+
+    for (int w = 0; w < workload_count; w++)
+        free(resolved[w]);
+    free(runs);
+    return EXIT_SUCCESS;
+}
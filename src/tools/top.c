@@ -0,0 +1,164 @@
+/*
+ * Live viewer for a running simulation.
+ * Samples the scheduler's metrics page (see metrics_page.h) every interval
+ * and renders it, until the run finishes. Runs in the namespace given by
+ * OS_SIM_IPC_NS like the simulator itself.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/shm.h>
+#include "headers.h"
+#include "des_engine.h"
+#include "ipc_keys.h"
+#include "metrics_page.h"
+
+#define DEPTH_BAR_WIDTH 40
+
+static const char* engine_name(int engine)
+{
+    if (engine == ENGINE_DES) return "des";
+    if (engine == ENGINE_HOST) return "host";
+    return "proc";
+}
+
+static const char* algorithm_name(int type)
+{
+    if (type == HPF) return "hpf";
+    if (type == SRTN) return "srtn";
+    return "rr";
+}
+
+// Upper edge of the bucket holding the given share of the completions, nearest rank
+static double wta_percentile(const metrics_page_t* sample, double share)
+{
+    int rank = (int)(share * sample->completions + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    int seen = 0;
+    for (int bucket = 0; bucket <= METRICS_WTA_BUCKETS; bucket++)
+    {
+        seen += sample->wta_histogram[bucket];
+        if (seen >= rank)
+            return (bucket + 1) * METRICS_WTA_BUCKET_WIDTH;
+    }
+    return (METRICS_WTA_BUCKETS + 1) * METRICS_WTA_BUCKET_WIDTH;
+}
+
+static void render(const metrics_page_t* sample, int max_depth, int clear)
+{
+    if (clear)
+        printf("\033[H\033[2J");
+
+    printf("os-sim-top  scheduler %d  engine %s  algorithm %s%s\n", sample->scheduler_pid,
+           engine_name(sample->engine), algorithm_name(sample->scheduler_type), sample->live ? "" : "  (finished)");
+    printf("tick %d\n", sample->tick);
+    if (sample->running_id)
+        printf("cpu 0: process %d (pid %d) for %d ticks\n", sample->running_id, sample->running_pid,
+               sample->tick - sample->running_since);
+    else
+        printf("cpu 0: idle\n");
+
+    int filled = max_depth ? sample->ready_depth * DEPTH_BAR_WIDTH / max_depth : 0;
+    printf("ready %5d [", sample->ready_depth);
+    for (int i = 0; i < DEPTH_BAR_WIDTH; i++)
+        putchar(i < filled ? '#' : ' ');
+    printf("] max %d\n", max_depth);
+    printf("processes %d  completions %d\n", sample->processes, sample->completions);
+
+    int total = sample->busy_ticks + sample->idle_ticks;
+    printf("busy %d  idle %d  utilization %.2f%%\n", sample->busy_ticks, sample->idle_ticks,
+           total ? 100.0 * sample->busy_ticks / total : 0.0);
+    if (sample->completions)
+        printf("WTA avg %.2f  p50 %.1f  p95 %.1f  p99 %.1f\n", sample->wta_sum / sample->completions,
+               wta_percentile(sample, 0.50), wta_percentile(sample, 0.95), wta_percentile(sample, 0.99));
+    else
+        printf("WTA -\n");
+    fflush(stdout);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -i <ms>      sampling interval in milliseconds (default 500)\n"
+            "  -n <count>   stop after this many samples (default: until the run finishes)\n",
+            name);
+}
+
+int main(int argc, char* argv[])
+{
+    long interval_ms = 500;
+    long count = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': interval_ms = atol(optarg);
+            break;
+        case 'n': count = atol(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (interval_ms < 1 || count < 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The scheduler creates the page once it starts
+    int shm_id;
+    int waiting = 0;
+    while ((shm_id = shmget(ipc_key(METRICS_SHM_KEY), 0, 0)) == -1)
+    {
+        if (errno != ENOENT)
+        {
+            perror("[TOP] Error finding the metrics page");
+            return EXIT_FAILURE;
+        }
+        if (!waiting)
+            fprintf(stderr, "[TOP] Waiting for a simulation to start\n");
+        waiting = 1;
+        usleep(interval_ms * 1000);
+    }
+
+    const metrics_page_t* page = (const metrics_page_t*)shmat(shm_id, NULL, SHM_RDONLY);
+    if ((void*)page == (void*)-1)
+    {
+        perror("[TOP] Error attaching the metrics page");
+        return EXIT_FAILURE;
+    }
+
+    int clear = isatty(STDOUT_FILENO);
+    int max_depth = 0;
+    metrics_page_t sample;
+    for (long taken = 0; count == 0 || taken < count; taken++)
+    {
+        memcpy(&sample, (const void*)page, sizeof(sample));
+        if (sample.ready_depth > max_depth)
+            max_depth = sample.ready_depth;
+        render(&sample, max_depth, clear);
+
+        if (!sample.live)
+            break;
+        // A killed scheduler leaves the page behind
+        if (kill(sample.scheduler_pid, 0) == -1 && errno == ESRCH)
+        {
+            fprintf(stderr, "[TOP] The scheduler exited without finishing the run\n");
+            break;
+        }
+        usleep(interval_ms * 1000);
+    }
+
+    shmdt((const void*)page);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Converts workloads between the tab-separated text format (processes.txt)
+ * and the binary columnar format that os-sim maps directly.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "workload.h"
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-b | -t] <input-workload> <output-workload>\n", name);
+    fprintf(stderr, "  -b  write the binary format\n");
+    fprintf(stderr, "  -t  write the text format\n");
+    fprintf(stderr, "Without -b/-t the output is the other format than the input.\n");
+}
+
+/*
+ * Binary inputs say whether they have the memory size and I/O columns, text
+ * inputs take a pass over their records. The pass stops once both are found.
+ */
+static void find_optional_columns(workload_reader_t* reader, const char* input, workload_writer_t* writer)
+{
+    if (reader->binary)
+    {
+        writer->with_memsize = workload_has_memsize(reader);
+        writer->with_io = workload_has_io(reader);
+        return;
+    }
+
+    workload_reader_t scan;
+    if (workload_open(&scan, input) == -1)
+        return;
+    processParameters params;
+    while (!(writer->with_memsize && writer->with_io) && workload_next(&scan, &params))
+    {
+        writer->with_memsize |= params.memsize > 0;
+        writer->with_io |= params.io_interval > 0;
+    }
+    workload_close(&scan);
+}
+
+int main(int argc, char* argv[])
+{
+    int output_binary = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "bt")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b':
+            output_binary = 1;
+            break;
+        case 't':
+            output_binary = 0;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* input = argv[optind];
+    const char* output = argv[optind + 1];
+
+    workload_reader_t reader;
+    if (workload_open(&reader, input) == -1)
+    {
+        perror("[CONVERT] Error opening input workload");
+        return EXIT_FAILURE;
+    }
+    if (output_binary == -1)
+        output_binary = !reader.binary;
+
+    workload_writer_t writer;
+    if (workload_writer_open(&writer, output, output_binary) == -1)
+    {
+        perror("[CONVERT] Error opening output workload");
+        workload_close(&reader);
+        return EXIT_FAILURE;
+    }
+    find_optional_columns(&reader, input, &writer);
+
+    processParameters params;
+    long count = 0;
+    while (workload_next(&reader, &params))
+    {
+        if (workload_write(&writer, &params) == -1)
+        {
+            perror("[CONVERT] Error writing workload");
+            workload_close(&reader);
+            return EXIT_FAILURE;
+        }
+        count++;
+    }
+    workload_close(&reader);
+
+    if (workload_writer_close(&writer) == -1)
+    {
+        perror("[CONVERT] Error writing workload");
+        return EXIT_FAILURE;
+    }
+
+    printf("[CONVERT] Wrote %ld processes to %s (%s)\n", count, output, output_binary ? "binary" : "text");
+    return EXIT_SUCCESS;
+}
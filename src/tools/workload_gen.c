@@ -0,0 +1,336 @@
+/*
+ * Seeded synthetic workload generator.
+ * Arrival times follow a Poisson, bursty (two-state MMPP) or diurnal process
+ * whose mean rate is set from the target utilization, runtimes follow an
+ * exponential, bimodal or Pareto distribution, and priorities are drawn from
+ * a weighted mix. The same seed and options always produce the same file.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <stdint.h>
+#include <getopt.h>
+#include "workload.h"
+
+#define ARRIVALS_POISSON 0
+#define ARRIVALS_MMPP 1
+#define ARRIVALS_DIURNAL 2
+
+#define RUNTIMES_EXPONENTIAL 0
+#define RUNTIMES_BIMODAL 1
+#define RUNTIMES_PARETO 2
+
+#define MAX_PRIORITY_LEVELS 64
+
+// Bimodal runtimes: this share of jobs is this many times longer than the rest
+#define BIMODAL_LONG_SHARE 0.1
+#define BIMODAL_LONG_FACTOR 10.0
+
+// Bursty arrivals: mean length (in ticks) of each MMPP state
+#define MMPP_MEAN_STATE_LENGTH 50.0
+
+static uint64_t rng_state;
+// Memory sizes have their own stream so adding them leaves the other columns of a seed unchanged
+static uint64_t memsize_rng_state;
+static uint64_t io_rng_state; // Likewise for the I/O columns
+
+// splitmix64, small and identical on every platform unlike rand()
+static uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t next_random()
+{
+    return splitmix64(&rng_state);
+}
+
+// Uniform in (0, 1)
+static double uniform()
+{
+    return ((next_random() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static double exponential(double mean)
+{
+    return -mean * log(uniform());
+}
+
+static int parse_choice(const char* value, const char* const* names, int count)
+{
+    for (int i = 0; i < count; i++)
+        if (strcmp(value, names[i]) == 0)
+            return i;
+    return -1;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s -n <count> [options]\n"
+            "  -n, --count <n>            number of processes to generate\n"
+            "  -s, --seed <seed>          random seed (default 1)\n"
+            "  -o, --output <file>        output file (default processes.txt)\n"
+            "  -b, --binary               write the binary workload format\n"
+            "  -a, --arrivals <process>   poisson, mmpp or diurnal (default poisson)\n"
+            "  -r, --runtimes <dist>      exponential, bimodal or pareto (default exponential)\n"
+            "  -m, --mean-runtime <t>     mean runtime in ticks (default 5)\n"
+            "  -u, --utilization <u>      target CPU utilization, sets the arrival rate (default 0.8)\n"
+            "  -p, --priorities <w,...>   weights of priority 0, 1, ... (default 1,1,1,1,1,1,1,1,1,1,1)\n"
+            "      --pareto-alpha <a>     Pareto shape, must be > 1 (default 1.5)\n"
+            "      --burst-factor <f>     mmpp: rate of the bursty state over the mean rate (default 4)\n"
+            "      --period <t>           diurnal: period in ticks (default 1000)\n"
+            "      --amplitude <a>        diurnal: relative swing of the rate in [0, 1] (default 0.8)\n"
+            "      --memsize <lo>[-<hi>]  add a memory size column, uniform in [lo, hi] bytes\n"
+            "      --io <lo>[-<hi>]       add I/O columns, a request every lo to hi CPU ticks\n"
+            "      --io-devices <n>       I/O requests go to a device uniform in [0, n) (default 1)\n",
+            name);
+}
+
+int main(int argc, char* argv[])
+{
+    static const char* const arrival_names[] = {"poisson", "mmpp", "diurnal"};
+    static const char* const runtime_names[] = {"exponential", "bimodal", "pareto"};
+
+    long count = -1;
+    uint64_t seed = 1;
+    const char* output = "processes.txt";
+    int binary = 0;
+    int arrivals = ARRIVALS_POISSON;
+    int runtimes = RUNTIMES_EXPONENTIAL;
+    double mean_runtime = 5.0;
+    double utilization = 0.8;
+    double pareto_alpha = 1.5;
+    double burst_factor = 4.0;
+    double period = 1000.0;
+    double amplitude = 0.8;
+    double priority_weights[MAX_PRIORITY_LEVELS];
+    int priority_levels = 11;
+    long memsize_low = 0, memsize_high = 0; // 0 leaves the memory size column out
+    long io_low = 0, io_high = 0; // 0 leaves the I/O columns out
+    long io_devices = 1;
+    for (int i = 0; i < priority_levels; i++)
+        priority_weights[i] = 1.0;
+
+    static struct option long_options[] = {
+        {"count", required_argument, NULL, 'n'},
+        {"seed", required_argument, NULL, 's'},
+        {"output", required_argument, NULL, 'o'},
+        {"binary", no_argument, NULL, 'b'},
+        {"arrivals", required_argument, NULL, 'a'},
+        {"runtimes", required_argument, NULL, 'r'},
+        {"mean-runtime", required_argument, NULL, 'm'},
+        {"utilization", required_argument, NULL, 'u'},
+        {"priorities", required_argument, NULL, 'p'},
+        {"pareto-alpha", required_argument, NULL, 'A'},
+        {"burst-factor", required_argument, NULL, 'B'},
+        {"period", required_argument, NULL, 'P'},
+        {"amplitude", required_argument, NULL, 'M'},
+        {"memsize", required_argument, NULL, 'S'},
+        {"io", required_argument, NULL, 'I'},
+        {"io-devices", required_argument, NULL, 'D'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:s:o:ba:r:m:u:p:", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            count = atol(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'b':
+            binary = 1;
+            break;
+        case 'a':
+            arrivals = parse_choice(optarg, arrival_names, 3);
+            break;
+        case 'r':
+            runtimes = parse_choice(optarg, runtime_names, 3);
+            break;
+        case 'm':
+            mean_runtime = atof(optarg);
+            break;
+        case 'u':
+            utilization = atof(optarg);
+            break;
+        case 'p':
+            {
+                priority_levels = 0;
+                char* weights = strdup(optarg);
+                for (char* w = strtok(weights, ","); w && priority_levels < MAX_PRIORITY_LEVELS;
+                     w = strtok(NULL, ","))
+                    priority_weights[priority_levels++] = atof(w);
+                free(weights);
+                break;
+            }
+        case 'A':
+            pareto_alpha = atof(optarg);
+            break;
+        case 'B':
+            burst_factor = atof(optarg);
+            break;
+        case 'P':
+            period = atof(optarg);
+            break;
+        case 'M':
+            amplitude = atof(optarg);
+            break;
+        case 'S':
+            {
+                char* end;
+                memsize_low = strtol(optarg, &end, 10);
+                memsize_high = *end == '-' ? strtol(end + 1, NULL, 10) : memsize_low;
+                break;
+            }
+        case 'I':
+            {
+                char* end;
+                io_low = strtol(optarg, &end, 10);
+                io_high = *end == '-' ? strtol(end + 1, NULL, 10) : io_low;
+                break;
+            }
+        case 'D':
+            io_devices = atol(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (count < 0 || arrivals == -1 || runtimes == -1 || mean_runtime < 1.0 || utilization <= 0.0 ||
+        pareto_alpha <= 1.0 || burst_factor < 1.0 || period <= 0.0 || amplitude < 0.0 || amplitude > 1.0 ||
+        priority_levels == 0 || memsize_low < 0 || memsize_high < memsize_low || memsize_high > INT_MAX ||
+        io_low < 0 || io_high < io_low || io_high > INT_MAX || io_devices < 1 || io_devices > INT_MAX)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    double total_weight = 0;
+    for (int i = 0; i < priority_levels; i++)
+        total_weight += priority_weights[i];
+    if (total_weight <= 0)
+    {
+        fprintf(stderr, "[GENERATOR] Priority weights must add up to more than 0\n");
+        return EXIT_FAILURE;
+    }
+
+    workload_writer_t writer;
+    if (workload_writer_open(&writer, output, binary) == -1)
+    {
+        perror("[GENERATOR] Error opening output");
+        return EXIT_FAILURE;
+    }
+    writer.with_memsize = memsize_high > 0;
+    writer.with_io = io_high > 0;
+
+    rng_state = seed;
+    memsize_rng_state = seed ^ 0x6D656D73697A6531ULL;
+    io_rng_state = seed ^ 0x696F696E74657276ULL;
+
+    // Utilization = arrival rate * mean runtime
+    double rate = utilization / mean_runtime;
+    double bimodal_short = mean_runtime / (1.0 - BIMODAL_LONG_SHARE + BIMODAL_LONG_SHARE * BIMODAL_LONG_FACTOR);
+    double pareto_scale = mean_runtime * (pareto_alpha - 1.0) / pareto_alpha;
+
+    // MMPP: the bursty state runs at burst_factor * rate, the quiet state makes up the mean
+    double mmpp_rates[2] = {rate * burst_factor, rate / burst_factor};
+    double bursty_share = (1.0 - 1.0 / burst_factor) / (burst_factor - 1.0 / burst_factor);
+    if (burst_factor == 1.0)
+        bursty_share = 0.5;
+    double mmpp_lengths[2] = {
+        2 * MMPP_MEAN_STATE_LENGTH * bursty_share, 2 * MMPP_MEAN_STATE_LENGTH * (1.0 - bursty_share)
+    };
+    int mmpp_state = 1;
+    double mmpp_state_end = exponential(mmpp_lengths[mmpp_state]);
+
+    double now = 1.0;
+    for (long i = 1; i <= count; i++)
+    {
+        if (arrivals == ARRIVALS_POISSON)
+            now += exponential(1.0 / rate);
+        else if (arrivals == ARRIVALS_MMPP)
+        {
+            // Memoryless gaps can be redrawn whenever the state switches
+            double next = now + exponential(1.0 / mmpp_rates[mmpp_state]);
+            while (next > mmpp_state_end)
+            {
+                now = mmpp_state_end;
+                mmpp_state = !mmpp_state;
+                mmpp_state_end = now + exponential(mmpp_lengths[mmpp_state]);
+                next = now + exponential(1.0 / mmpp_rates[mmpp_state]);
+            }
+            now = next;
+        }
+        else
+        {
+            // Thinning against the peak rate of the sinusoid
+            double peak = rate * (1.0 + amplitude);
+            do
+                now += exponential(1.0 / peak);
+            while (uniform() * peak > rate * (1.0 + amplitude * sin(2.0 * M_PI * now / period)));
+        }
+
+        double runtime;
+        if (runtimes == RUNTIMES_EXPONENTIAL)
+            runtime = exponential(mean_runtime);
+        else if (runtimes == RUNTIMES_BIMODAL)
+            runtime = exponential(uniform() < BIMODAL_LONG_SHARE ? bimodal_short * BIMODAL_LONG_FACTOR : bimodal_short);
+        else
+            runtime = pareto_scale / pow(uniform(), 1.0 / pareto_alpha);
+
+        double pick = uniform() * total_weight;
+        int priority = 0;
+        while (priority < priority_levels - 1 && pick >= priority_weights[priority])
+            pick -= priority_weights[priority++];
+
+        processParameters params;
+        params.mtype = 1;
+        params.id = (int)i;
+        params.pid = -1;
+        params.arrival_time = now > INT_MAX ? INT_MAX : (int)now;
+        // No zero-length jobs
+        params.runtime = runtime < 1.0 ? 1 : (runtime > INT_MAX ? INT_MAX : (int)(runtime + 0.5));
+        params.priority = priority;
+        params.memsize = 0;
+        if (writer.with_memsize)
+            params.memsize = (int)(memsize_low + splitmix64(&memsize_rng_state) %
+                (uint64_t)(memsize_high - memsize_low + 1));
+        params.io_interval = 0;
+        params.io_device = 0;
+        if (writer.with_io)
+        {
+            params.io_interval = (int)(io_low + splitmix64(&io_rng_state) % (uint64_t)(io_high - io_low + 1));
+            params.io_device = (int)(splitmix64(&io_rng_state) % (uint64_t)io_devices);
+        }
+
+        if (workload_write(&writer, &params) == -1)
+        {
+            perror("[GENERATOR] Error writing workload");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (workload_writer_close(&writer) == -1)
+    {
+        perror("[GENERATOR] Error writing workload");
+        return EXIT_FAILURE;
+    }
+
+    printf("[GENERATOR] Wrote %ld processes to %s (%s)\n", count, output, binary ? "binary" : "text");
+    return EXIT_SUCCESS;
+}